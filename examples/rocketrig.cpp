@@ -47,7 +47,7 @@
 
 using namespace Beatnik;
 
-static char* shortargs = (char*)"n:t:d:x:F:o:I:b:g:a:T:m:v:p:i:w:O:M:e:h";
+static char* shortargs = (char*)"n:t:d:x:F:o:I:b:g:a:T:m:v:p:i:w:O:M:e:SK:B:A:L:P:CR:G:uc:E:D:N:fVh";
 
 static option longargs[] = {
     // Basic simulation parameters
@@ -75,6 +75,24 @@ static option longargs[] = {
     { "mu", required_argument, NULL, 'M' },
     { "epsilon", required_argument, NULL, 'e' },
 
+    // Solution method tuning parameters
+    { "br-symmetric", no_argument, NULL, 'S' },
+    { "br-kernel", required_argument, NULL, 'K' },
+    { "br-solver", required_argument, NULL, 'B' },
+    { "br-theta", required_argument, NULL, 'A' },
+    { "br-leaf-size", required_argument, NULL, 'L' },
+    { "br-fmm-order", required_argument, NULL, 'P' },
+    { "br-fmm-check", no_argument, NULL, 'C' },
+    { "br-cutoff", required_argument, NULL, 'R' },
+    { "br-mesh-spacing", required_argument, NULL, 'G' },
+    { "fft-autotune", no_argument, NULL, 'u' },
+    { "fft-tune-cache", required_argument, NULL, 'c' },
+    { "dt-tolerance", required_argument, NULL, 'E' },
+    { "dt-max", required_argument, NULL, 'D' },
+    { "time-scheme", required_argument, NULL, 'N' },
+    { "fuse-stages", no_argument, NULL, 'f' },
+    { "implicit-viscosity", no_argument, NULL, 'V' },
+
     // Miscellaneous other arguments
     { "help", no_argument, NULL, 'h' },
     { 0, 0, 0, 0 } };
@@ -116,8 +134,17 @@ struct ClArgs
     enum SolverOrder order;  /**< Order of z-model solver to use */
     double mu;      /**< Artificial viscosity constant */
     double eps;     /**< Desingularization constant */
+
+    /* Solution method tuning parameters */
+    Beatnik::SolverParams params; /**< Options for how the solver solves the problem */
 };
 
+/* Command line names of the solver options, indexed by their enum values,
+ * so the options are printed the way they are given */
+const char * const br_kernel_names[] = { "flat", "team", "tiled", "simd" };
+const char * const br_solver_names[] = { "exact", "treecode", "fmm", "cutoff", "p3m", "vic" };
+const char * const time_scheme_names[] = { "rk3", "ssprk104", "ssprk43", "rk4" };
+
 /**
  * Outputs help message explaining command line options.
  * @param rank The rank calling the function
@@ -165,6 +192,39 @@ void help( const int rank, char* progname )
         std::cout << std::left << std::setw( 10 ) << "-e" << std::setw( 40 )
 		<< "Desingularization Constant (defailt 0.25)" << std::left << "\n";
 
+        std::cout << std::left << std::setw( 10 ) << "-S" << std::setw( 40 )
+                  << "Use Symmetric Exact BR Pair Evaluation (default off)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-K" << std::setw( 40 )
+                  << "Exact BR Kernel (flat, team, tiled, simd) (default \"flat\")" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-B" << std::setw( 40 )
+                  << "BR Solver (exact, treecode, fmm, cutoff, p3m, vic) (default \"exact\")" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-A" << std::setw( 40 )
+                  << "Treecode Opening Angle (default 0.5)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-L" << std::setw( 40 )
+                  << "Tree Leaf Size for Treecode and FMM (default 32)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-P" << std::setw( 40 )
+                  << "FMM Expansion Order (default 4)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-C" << std::setw( 40 )
+                  << "Check FMM Accuracy Against Exact BR (default off)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-R" << std::setw( 40 )
+                  << "Cutoff and P3M Direct Interaction Radius (default 0.5)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-G" << std::setw( 40 )
+                  << "P3M and Vortex-in-Cell Mesh Spacing (default 0.1)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-u" << std::setw( 40 )
+                  << "Autotune Reisz Transform FFT Plan (default off)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-c" << std::setw( 40 )
+                  << "FFT Autotuning Cache File, Implies -u (default none)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-E" << std::setw( 40 )
+                  << "Adaptive Timestep Error Tolerance, -d Sets First Step (default 0, fixed)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-D" << std::setw( 40 )
+                  << "Largest Adaptive Timestep (default 0, unlimited)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-N" << std::setw( 40 )
+                  << "Time Integration Scheme (rk3, ssprk43, ssprk104, rk4) (default \"rk3\")" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-f" << std::setw( 40 )
+                  << "Fuse RK3 Stage Updates Into the Z-Model Kernels (default off)" << std::left << "\n";
+        std::cout << std::left << std::setw( 10 ) << "-V" << std::setw( 40 )
+                  << "Implicit Spectral Artificial Viscosity, Periodic Only (default off)" << std::left << "\n";
+
         std::cout << std::left << std::setw( 10 ) << "-h" << std::setw( 40 )
                   << "Print Help Message" << std::left << "\n";
     }
@@ -405,6 +465,177 @@ int parseInput( const int rank, const int argc, char** argv, ClArgs& cl )
                 exit( -1 );
             }
             break;
+        case 'S':
+            cl.params.br_symmetric = true;
+            break;
+        case 'K':
+        {
+            std::string kernel(optarg);
+            if (kernel.compare("flat") == 0) {
+                cl.params.br_kernel = Beatnik::BR_KERNEL_FLAT;
+            } else if (kernel.compare("team") == 0) {
+                cl.params.br_kernel = Beatnik::BR_KERNEL_TEAM;
+            } else if (kernel.compare("tiled") == 0) {
+                cl.params.br_kernel = Beatnik::BR_KERNEL_TILED;
+            } else if (kernel.compare("simd") == 0) {
+                cl.params.br_kernel = Beatnik::BR_KERNEL_SIMD;
+            } else {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid exact BR kernel.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        }
+        case 'B':
+        {
+            std::string solver(optarg);
+            if (solver.compare("exact") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_EXACT;
+            } else if (solver.compare("treecode") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_TREECODE;
+            } else if (solver.compare("fmm") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_FMM;
+            } else if (solver.compare("cutoff") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_CUTOFF;
+            } else if (solver.compare("p3m") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_P3M;
+            } else if (solver.compare("vic") == 0) {
+                cl.params.br_solver = Beatnik::BR_SOLVER_VIC;
+            } else {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid BR solver.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        }
+        case 'A':
+            cl.params.br_theta = atof( optarg );
+            if ( cl.params.br_theta <= 0.0 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid treecode opening angle.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'L':
+            cl.params.br_leaf_size = atoi( optarg );
+            if ( cl.params.br_leaf_size < 1 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid tree leaf size.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'P':
+            cl.params.br_fmm_order = atoi( optarg );
+            if ( cl.params.br_fmm_order < 1 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid FMM expansion order.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'C':
+            cl.params.br_fmm_check = true;
+            break;
+        case 'R':
+            cl.params.br_cutoff = atof( optarg );
+            if ( cl.params.br_cutoff <= 0.0 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid BR cutoff distance.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'G':
+            cl.params.br_mesh_spacing = atof( optarg );
+            if ( cl.params.br_mesh_spacing <= 0.0 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid BR spatial mesh spacing.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'u':
+            cl.params.fft_autotune = true;
+            break;
+        case 'c':
+            cl.params.fft_autotune = true;
+            cl.params.fft_tune_cache = optarg;
+            break;
+        case 'E':
+            cl.params.dt_tolerance = atof( optarg );
+            if ( cl.params.dt_tolerance < 0.0 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid adaptive timestep tolerance.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'D':
+            cl.params.dt_max = atof( optarg );
+            if ( cl.params.dt_max < 0.0 )
+            {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid largest adaptive timestep.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        case 'N':
+        {
+            std::string scheme(optarg);
+            if (scheme.compare("rk3") == 0) {
+                cl.params.time_scheme = Beatnik::TIME_TVD_RK3;
+            } else if (scheme.compare("ssprk43") == 0) {
+                cl.params.time_scheme = Beatnik::TIME_SSP_RK43;
+            } else if (scheme.compare("ssprk104") == 0
+                       || scheme.compare("ssprk104-ls") == 0) {
+                cl.params.time_scheme = Beatnik::TIME_LS_SSP_RK104;
+            } else if (scheme.compare("rk4") == 0) {
+                cl.params.time_scheme = Beatnik::TIME_RK4;
+            } else {
+                if ( rank == 0 )
+                {
+                    std::cerr << "Invalid time integration scheme.\n";
+                    help( rank, argv[0] );
+                }
+                exit( -1 );
+            }
+            break;
+        }
+        case 'f':
+            cl.params.fuse_stages = true;
+            break;
+        case 'V':
+            cl.params.implicit_viscosity = true;
+            break;
         case 'h':
             help( rank, argv[0] );
             exit( 0 );
@@ -569,19 +800,22 @@ void rocketrig( ClArgs& cl )
             cl.driver, MPI_COMM_WORLD,
             cl.global_bounding_box, cl.num_nodes,
             partitioner, cl.atwood, cl.gravity, initializer,
-            bc, Beatnik::Order::Low(), cl.mu, cl.eps, cl.delta_t );
+            bc, Beatnik::Order::Low(), cl.mu, cl.eps, cl.delta_t,
+            cl.params );
     } else if (cl.order == SolverOrder::ORDER_MEDIUM) {
         solver = Beatnik::createSolver(
             cl.driver, MPI_COMM_WORLD,
             cl.global_bounding_box, cl.num_nodes,
             partitioner, cl.atwood, cl.gravity, initializer,
-            bc, Beatnik::Order::Medium(), cl.mu, cl.eps, cl.delta_t );
+            bc, Beatnik::Order::Medium(), cl.mu, cl.eps, cl.delta_t,
+            cl.params );
     } else if (cl.order == SolverOrder::ORDER_HIGH) {
         solver = Beatnik::createSolver(
             cl.driver, MPI_COMM_WORLD,
             cl.global_bounding_box, cl.num_nodes,
             partitioner, cl.atwood, cl.gravity, initializer,
-            bc, Beatnik::Order::High(), cl.mu, cl.eps, cl.delta_t );
+            bc, Beatnik::Order::High(), cl.mu, cl.eps, cl.delta_t,
+            cl.params );
     } else {
         std::cerr << "Invalid Model Order parameter!\n";
         exit(-1);
@@ -636,6 +870,36 @@ int main( int argc, char* argv[] )
                   << ": " << std::setw( 8 ) << cl.mu << "\n";
         std::cout << std::left << std::setw( 30 ) << "Desingularization"
                   << ": " << std::setw( 8 ) << cl.eps  << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Symmetric BR Evaluation"
+                  << ": " << std::setw( 8 ) << cl.params.br_symmetric << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Exact BR Kernel"
+                  << ": " << std::setw( 8 ) << br_kernel_names[cl.params.br_kernel] << "\n";
+        std::cout << std::left << std::setw( 30 ) << "BR Solver"
+                  << ": " << std::setw( 8 ) << br_solver_names[cl.params.br_solver] << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Treecode Opening Angle"
+                  << ": " << std::setw( 8 ) << cl.params.br_theta << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Tree Leaf Size"
+                  << ": " << std::setw( 8 ) << cl.params.br_leaf_size << "\n";
+        std::cout << std::left << std::setw( 30 ) << "FMM Expansion Order"
+                  << ": " << std::setw( 8 ) << cl.params.br_fmm_order << "\n";
+        std::cout << std::left << std::setw( 30 ) << "FMM Accuracy Check"
+                  << ": " << std::setw( 8 ) << cl.params.br_fmm_check << "\n";
+        std::cout << std::left << std::setw( 30 ) << "BR Cutoff Distance"
+                  << ": " << std::setw( 8 ) << cl.params.br_cutoff << "\n";
+        std::cout << std::left << std::setw( 30 ) << "BR Mesh Spacing"
+                  << ": " << std::setw( 8 ) << cl.params.br_mesh_spacing << "\n";
+        std::cout << std::left << std::setw( 30 ) << "FFT Autotuning"
+                  << ": " << std::setw( 8 ) << cl.params.fft_autotune << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Timestep Error Tolerance"
+                  << ": " << std::setw( 8 ) << cl.params.dt_tolerance << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Largest Adaptive Timestep"
+                  << ": " << std::setw( 8 ) << cl.params.dt_max << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Time Integration Scheme"
+                  << ": " << std::setw( 8 ) << time_scheme_names[cl.params.time_scheme] << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Fused Stage Updates"
+                  << ": " << std::setw( 8 ) << cl.params.fuse_stages << "\n";
+        std::cout << std::left << std::setw( 30 ) << "Implicit Viscosity"
+                  << ": " << std::setw( 8 ) << cl.params.implicit_viscosity << "\n";
         std::cout << "==============================================\n";
     }
 
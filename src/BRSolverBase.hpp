@@ -0,0 +1,68 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file BRSolverBase.hpp
+ *
+ * @section DESCRIPTION
+ * Interface shared by the Birkhoff-Rott far-field solvers, so that the
+ * solver used by the ZModel can be chosen at runtime. A new engine derives
+ * from BRSolverBase, is constructed from (pm, bc, epsilon, dx, dy, params),
+ * and is added to createBRSolver in Solver.hpp.
+ */
+
+#ifndef BEATNIK_BRSOLVERBASE_HPP
+#define BEATNIK_BRSOLVERBASE_HPP
+
+// Include Statements
+#include <Kokkos_Core.hpp>
+
+#include <ostream>
+
+namespace Beatnik
+{
+
+/**
+ * The BRSolverBase Class
+ * @class BRSolverBase
+ * @brief Abstract Birkhoff-Rott solver computing the interface velocity
+ * from the interface position and vorticity
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class BRSolverBase
+{
+  public:
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    virtual ~BRSolverBase() = default;
+
+    /* Compute the velocity zdot of the owned interface points */
+    virtual void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const = 0;
+
+    /* Split form of computeInterfaceVelocity for callers that overlap other
+     * work with it: zdot is complete once Finish returns, and Progress may be
+     * called any number of times in between to advance the computation 
+     * without waiting for all of it. Solvers that can't run asynchronously 
+     * do all of the work in Begin. */
+    virtual void computeInterfaceVelocityBegin(node_view zdot, node_view z, node_view w) const
+    {
+        computeInterfaceVelocity(zdot, z, w);
+    }
+    virtual void computeInterfaceVelocityProgress() const {}
+    virtual void computeInterfaceVelocityFinish() const {}
+
+    /* Report where the solver spent its time on the first process */
+    virtual void printTimings(std::ostream & out) const = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_BRSOLVERBASE_HPP
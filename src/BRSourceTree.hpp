@@ -0,0 +1,621 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file BRSourceTree.hpp
+ *
+ * @section DESCRIPTION
+ * Distributed octree over the Birkhoff-Rott sources shared by the tree-based
+ * far-field solvers. Each process computes the quadrature-weighted vorticity
+ * of the surface nodes it owns and builds a local octree over just those
+ * sources. The solver then adds its expansions to the local tree, and every
+ * process sends each other process (and each periodic image of itself) its
+ * locally essential tree: the expansion of any cell that is well separated
+ * from the bounding box of the receiver's points, and the raw sources of
+ * the leaves that are not. Each process then builds a second octree over
+ * its own sources and everything it received, with the received periodic
+ * images already shifted into place, and the solver evaluates that tree for
+ * the points it owns. No process ever holds more than its own sources plus
+ * the part of the rest of the interface it actually needs.
+ *
+ * Both trees are flattened into device views along with their sources and
+ * remote cells sorted into tree order, so that the solvers only have to add
+ * their expansions. The interface barely moves between the stages of a
+ * time step, so the local tree keeps its structure across calls and only
+ * has its sources and bounding spheres refit on the device, until the
+ * spheres have grown enough that it is worth sorting the sources again.
+ */
+
+#ifndef BEATNIK_BRSOURCETREE_HPP
+#define BEATNIK_BRSOURCETREE_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <BRSources.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The BRSourceTree Class
+ * @class BRSourceTree
+ * @brief Local and locally essential octrees over the quadrature-weighted BR
+ * sources of the interface
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class BRSourceTree
+{
+  public:
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using mesh_type = Cabana::Grid::UniformMesh<double, 2>;
+
+    using node_view = Kokkos::View<double***, device_type>;
+
+    /* Per-source position and weighted vorticity, per-cell geometry and
+     * per-cell links, stored structure-of-arrays */
+    using source_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type>;
+    using cell_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type>;
+    using link_view = Kokkos::View<int**, Kokkos::LayoutLeft, device_type>;
+    using index_view = Kokkos::View<int*, device_type>;
+
+    /* Doubles stored for each source: position then weighted vorticity */
+    static constexpr int source_size = BRSources<ExecutionSpace, MemorySpace>::source_size;
+
+    /* Doubles stored for each cell: the center of the bounding box of its
+     * sources, and the radius of the sphere around it holding them */
+    static constexpr int geometry_size = 4;
+
+    /* Doubles stored for each remote cell ahead of its expansion: its
+     * center and radius, in the same form as the cell geometry */
+    static constexpr int remote_header = 4;
+
+    /* Links stored for each cell: its range of sources in tree order, its
+     * contiguous range of children and its range of remote cells */
+    static constexpr int link_size = 6;
+    enum { LINK_BEGIN = 0, LINK_END = 1, LINK_CHILD = 2, LINK_NCHILD = 3,
+           LINK_REMOTE_BEGIN = 4, LINK_REMOTE_END = 5 };
+
+    /* Deepest tree we build, which bounds the traversal stack even when
+     * many sources sit on top of each other */
+    static constexpr int max_depth = 32;
+    static constexpr int stack_size = 7 * max_depth + 1;
+
+    /* The local tree is rebuilt rather than refit once the bounding sphere
+     * of any of its cells has grown by this factor since it was built */
+    static constexpr double refit_growth = 1.5;
+
+    /* One flattened octree. Cells are created breadth-first, so the
+     * children of each cell are contiguous and cells are ordered by depth. */
+    struct Octree
+    {
+        /* Host copies, used to pick out the parts of the tree other
+         * processes need. Sources are in tree order,
+         * source_size doubles per source. */
+        std::vector<std::array<int, link_size>> host_links;
+        std::vector<std::array<double, geometry_size>> host_geometry;
+        std::vector<int> host_depth;
+        std::vector<double> host_sources;
+
+        /* First cell of each level, followed by the number of cells */
+        std::vector<int> level_begin;
+
+        /* Device copies. Remote cells are in tree order, remote_header
+         * doubles followed by their expansion. */
+        link_view links;
+        cell_view geometry;
+        source_view sources;
+        source_view remote;
+
+        int numCells() const { return host_links.size(); }
+        int numSources() const { return host_sources.size() / source_size; }
+    };
+
+    BRSourceTree( const pm_type & pm, const BoundaryCondition & bc,
+                  const double dx, const double dy, const int leaf_size )
+        : _leaf_size( leaf_size )
+        , _sources( pm, bc, dx, dy )
+    {
+        _comm = pm.mesh().localGrid()->globalGrid().comm();
+        MPI_Comm_size(_comm, &_num_procs);
+        MPI_Comm_rank(_comm, &_rank);
+
+        int num_sources = _sources.numOwned();
+        _own_sources = source_view(Kokkos::ViewAllocateWithoutInitializing("Tree own sources"),
+                                   num_sources, source_size);
+        _own_index = index_view(Kokkos::ViewAllocateWithoutInitializing("Tree own index"),
+                                num_sources);
+        _local_order = index_view(Kokkos::ViewAllocateWithoutInitializing("Tree local order"),
+                                  num_sources);
+        _boxes.resize(6 * _num_procs);
+    }
+
+    /* Update the local tree over our own sources for the current interface
+     * position and vorticity, and share where our points are. The tree is
+     * refit if it is still a good fit for the sources and rebuilt if not. */
+    void update(node_view z, node_view w)
+    {
+        _sources.compute(ExecutionSpace(), _own_sources, z, w);
+        if (!refitLocalTree()) {
+            buildLocalTree();
+        }
+        gatherTargetBoxes();
+    }
+
+    /* Number of times the local tree has been refit and rebuilt */
+    int numRefits() const { return _num_refits; }
+    int numBuilds() const { return _num_builds; }
+
+    /**
+     * Exchange locally essential trees and build the essential tree
+     * @param expansions Expansion of each local tree cell, as computed by
+     * the solver after update()
+     * @param expansion_size Doubles in each cell expansion
+     * @param theta Opening angle: a local cell is sent as its expansion
+     * when its radius is less than theta times its distance from the
+     * receiver's bounding box. Zero sends every source.
+     **/
+    void exchange(cell_view expansions, int expansion_size, double theta)
+    {
+        int remote_width = remote_header + expansion_size;
+        auto host_expansions = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), expansions);
+
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
+
+        auto & links = _local.host_links;
+        auto & geometry = _local.host_geometry;
+        auto & sources = _local.host_sources;
+        double theta2 = theta * theta;
+
+        std::vector<std::vector<double>> send_sources(_num_procs), send_remote(_num_procs);
+        std::vector<int> stack;
+        for (int r = 0; r < _num_procs; r++) {
+            const double * box = &_boxes[6 * r];
+            if (box[0] > box[3]) continue;
+
+            for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                    // Our own sources go into our essential tree as they are
+                    if (r == _rank && kdir == 0 && ldir == 0) continue;
+                    double offset[3] = {kdir * width[0], ldir * width[1], 0.0};
+
+                    stack.assign(1, 0);
+                    while (!stack.empty()) {
+                        int c = stack.back();
+                        stack.pop_back();
+
+                        double center[3], dist2 = 0.0, radius = geometry[c][3];
+                        for (int d = 0; d < 3; d++) {
+                            center[d] = geometry[c][d] + offset[d];
+                            double gap = std::max({box[d] - center[d], center[d] - box[d + 3], 0.0});
+                            dist2 += gap * gap;
+                        }
+
+                        if (radius * radius < theta2 * dist2) {
+                            // Well separated from every point the receiver owns
+                            auto & out = send_remote[r];
+                            out.insert(out.end(), center, center + 3);
+                            out.push_back(radius);
+                            for (int e = 0; e < expansion_size; e++) {
+                                out.push_back(host_expansions(c, e));
+                            }
+                        } else if (links[c][LINK_NCHILD] == 0) {
+                            auto & out = send_sources[r];
+                            for (int s = links[c][LINK_BEGIN]; s < links[c][LINK_END]; s++) {
+                                for (int d = 0; d < source_size; d++) {
+                                    out.push_back(sources[source_size * s + d] + (d < 3 ? offset[d] : 0.0));
+                                }
+                            }
+                        } else {
+                            for (int k = 0; k < links[c][LINK_NCHILD]; k++) {
+                                stack.push_back(links[c][LINK_CHILD] + k);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /* Our own sources come first in the essential tree's source list */
+        std::vector<double> src(_host_own_sources), rem;
+        allToAll(send_sources, src);
+        allToAll(send_remote, rem);
+
+        std::vector<int> position;
+        buildTree(_essential, src, rem, remote_width, position);
+
+        int num_own = _own_index.extent(0);
+        auto own_index = Kokkos::create_mirror_view(_own_index);
+        for (int s = 0; s < num_own; s++) own_index(s) = position[s];
+        Kokkos::deep_copy(_own_index, own_index);
+    }
+
+    /* Tree over the sources this process owns, to which the solver adds the
+     * expansions exchange() sends */
+    const Octree & local() const { return _local; }
+
+    /* Tree over our own sources, the sources and cell expansions other
+     * processes sent us, and their periodic images */
+    const Octree & essential() const { return _essential; }
+
+    /* Position of each owned source in the essential tree, in the same
+     * (k, l) order as the sources are computed in */
+    index_view ownIndex() const { return _own_index; }
+
+  private:
+    /* Sort our own sources into a new local tree on the host and remember
+     * the order they went into it and the size of its cells */
+    void buildLocalTree()
+    {
+        auto own = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), _own_sources);
+        int num_own = own.extent(0);
+        _host_own_sources.resize(source_size * num_own);
+        for (int s = 0; s < num_own; s++) {
+            for (int d = 0; d < source_size; d++) {
+                _host_own_sources[source_size * s + d] = own(s, d);
+            }
+        }
+
+        buildTree(_local, _host_own_sources, std::vector<double>(), remote_header, _local_position);
+
+        auto order = Kokkos::create_mirror_view(_local_order);
+        for (int s = 0; s < num_own; s++) order(_local_position[s]) = s;
+        Kokkos::deep_copy(_local_order, order);
+
+        _built_radius = Kokkos::View<double*, device_type>(
+            Kokkos::ViewAllocateWithoutInitializing("Tree built radius"), _local.numCells());
+        Kokkos::deep_copy(_built_radius, Kokkos::subview(_local.geometry, Kokkos::ALL(), 3));
+        _num_builds++;
+    }
+
+    /* Move the sources of the local tree to their current positions and
+     * recompute the bounding sphere of each cell on the device, keeping the
+     * tree structure. Returns false, leaving the tree to be rebuilt, if
+     * there is no tree yet or one of the spheres has grown too much. */
+    bool refitLocalTree()
+    {
+        if (_local.numCells() == 0) return false;
+
+        using team_policy = Kokkos::TeamPolicy<ExecutionSpace>;
+        using member_type = typename team_policy::member_type;
+
+        auto own = _own_sources;
+        auto order = _local_order;
+        auto sources = _local.sources;
+        auto links = _local.links;
+        auto geometry = _local.geometry;
+        auto built_radius = _built_radius;
+        int num_own = own.extent(0), num_cells = _local.numCells();
+
+        Kokkos::parallel_for("BR Tree Refit Sources",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_own),
+            KOKKOS_LAMBDA(const int s) {
+            for (int d = 0; d < source_size; d++) sources(s, d) = own(order(s), d);
+        });
+
+        /* Each team reduces the bounding box and then the bounding sphere of
+         * one cell's sources, which are contiguous in tree order */
+        Kokkos::parallel_for("BR Tree Refit Geometry",
+            team_policy(num_cells, Kokkos::AUTO),
+            KOKKOS_LAMBDA(const member_type & team) {
+            int c = team.league_rank();
+            int begin = links(c, LINK_BEGIN), end = links(c, LINK_END);
+            auto range = Kokkos::TeamThreadRange(team, begin, end);
+
+            double center[3], radius = 0.0;
+            for (int d = 0; d < 3; d++) {
+                double low, high;
+                Kokkos::parallel_reduce(range, [&](const int s, double & l) {
+                    l = Kokkos::min(l, sources(s, d));
+                }, Kokkos::Min<double>(low));
+                Kokkos::parallel_reduce(range, [&](const int s, double & h) {
+                    h = Kokkos::max(h, sources(s, d));
+                }, Kokkos::Max<double>(high));
+                center[d] = (begin < end) ? 0.5 * (low + high) : 0.0;
+            }
+            Kokkos::parallel_reduce(range, [&](const int s, double & r) {
+                double dist2 = 0.0;
+                for (int d = 0; d < 3; d++) {
+                    dist2 += (sources(s, d) - center[d]) * (sources(s, d) - center[d]);
+                }
+                r = Kokkos::max(r, Kokkos::sqrt(dist2));
+            }, Kokkos::Max<double>(radius));
+
+            Kokkos::single(Kokkos::PerTeam(team), [&]() {
+                for (int d = 0; d < 3; d++) geometry(c, d) = center[d];
+                geometry(c, 3) = (begin < end) ? radius : 0.0;
+            });
+        });
+
+        int num_grown = 0;
+        Kokkos::parallel_reduce("BR Tree Refit Check",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells),
+            KOKKOS_LAMBDA(const int c, int & grown) {
+            if (geometry(c, 3) > refit_growth * built_radius(c)) grown++;
+        }, num_grown);
+        if (num_grown > 0) return false;
+
+        /* The exchange walks the local tree on the host */
+        auto h_sources = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), sources);
+        auto h_geometry = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), geometry);
+        for (int s = 0; s < num_own; s++) {
+            for (int d = 0; d < source_size; d++) {
+                _local.host_sources[source_size * s + d] = h_sources(s, d);
+                _host_own_sources[source_size * s + d] = h_sources(_local_position[s], d);
+            }
+        }
+        for (int c = 0; c < num_cells; c++) {
+            for (int d = 0; d < geometry_size; d++) _local.host_geometry[c][d] = h_geometry(c, d);
+        }
+        _num_refits++;
+        return true;
+    }
+
+    /* Share the bounding box of the points each process owns, low corner
+     * then high corner. A process without points sends an empty box. */
+    void gatherTargetBoxes()
+    {
+        double box[6];
+        for (int d = 0; d < 3; d++) {
+            box[d] = std::numeric_limits<double>::infinity();
+            box[d + 3] = -box[d];
+        }
+        expandBox(_host_own_sources, source_size, nullptr, 0,
+                  _host_own_sources.size() / source_size, box, box + 3);
+        MPI_Allgather(box, 6, MPI_DOUBLE, _boxes.data(), 6, MPI_DOUBLE, _comm);
+    }
+
+    /* Send each process its buffer and append what we receive to recv */
+    void allToAll(const std::vector<std::vector<double>> & send, std::vector<double> & recv) const
+    {
+        std::vector<int> send_counts(_num_procs), recv_counts(_num_procs);
+        std::vector<int> send_displs(_num_procs), recv_displs(_num_procs);
+        for (int r = 0; r < _num_procs; r++) send_counts[r] = send[r].size();
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, _comm);
+
+        int send_total = 0, recv_total = recv.size();
+        for (int r = 0; r < _num_procs; r++) {
+            send_displs[r] = send_total;
+            recv_displs[r] = recv_total;
+            send_total += send_counts[r];
+            recv_total += recv_counts[r];
+        }
+
+        std::vector<double> buffer;
+        buffer.reserve(send_total);
+        for (int r = 0; r < _num_procs; r++) {
+            buffer.insert(buffer.end(), send[r].begin(), send[r].end());
+        }
+        recv.resize(recv_total);
+        MPI_Alltoallv(buffer.data(), send_counts.data(), send_displs.data(), MPI_DOUBLE,
+                      recv.data(), recv_counts.data(), recv_displs.data(), MPI_DOUBLE, _comm);
+    }
+
+    /* Build an octree over a list of sources and remote cells on the host
+     * and copy it, along with the sources and remote cells sorted into tree
+     * order, to the device. A cell is split into octants around the middle
+     * of the bounding box of its sources and remote cell centers until it
+     * holds at most leaf_size of them. position is set to the tree position
+     * of each source. */
+    void buildTree(Octree & tree, const std::vector<double> & src,
+                   const std::vector<double> & rem, int remote_width,
+                   std::vector<int> & position) const
+    {
+        int n = src.size() / source_size, m = rem.size() / remote_width;
+
+        std::vector<int> sorder(n), rorder(m), scratch(std::max(n, m));
+        for (int s = 0; s < n; s++) sorder[s] = s;
+        for (int q = 0; q < m; q++) rorder[q] = q;
+
+        auto & links = tree.host_links;
+        auto & depth = tree.host_depth;
+        links.clear();
+        depth.clear();
+        links.push_back({0, n, 0, 0, 0, m});
+        depth.push_back(0);
+
+        for (std::size_t c = 0; c < links.size(); c++) {
+            int begin = links[c][LINK_BEGIN], end = links[c][LINK_END];
+            int rbegin = links[c][LINK_REMOTE_BEGIN], rend = links[c][LINK_REMOTE_END];
+            if ((end - begin) + (rend - rbegin) <= _leaf_size || depth[c] >= max_depth) continue;
+
+            double low[3], high[3], mid[3];
+            for (int d = 0; d < 3; d++) {
+                low[d] = std::numeric_limits<double>::infinity();
+                high[d] = -low[d];
+            }
+            expandBox(src, source_size, sorder.data(), begin, end, low, high);
+            expandBox(rem, remote_width, rorder.data(), rbegin, rend, low, high);
+            for (int d = 0; d < 3; d++) mid[d] = 0.5 * (low[d] + high[d]);
+
+            int count[8], rcount[8];
+            octantSort(src, source_size, sorder, begin, end, mid, count, scratch);
+            octantSort(rem, remote_width, rorder, rbegin, rend, mid, rcount, scratch);
+
+            links[c][LINK_CHILD] = links.size();
+            for (int o = 0, first = begin, rfirst = rbegin; o < 8;
+                 first += count[o], rfirst += rcount[o], o++) {
+                if (count[o] + rcount[o] == 0) continue;
+                links.push_back({first, first + count[o], 0, 0, rfirst, rfirst + rcount[o]});
+                depth.push_back(depth[c] + 1);
+                links[c][LINK_NCHILD]++;
+            }
+        }
+
+        /* Sort the sources and remote cells into tree order */
+        tree.host_sources.resize(source_size * n);
+        position.resize(n);
+        for (int s = 0; s < n; s++) {
+            for (int d = 0; d < source_size; d++) {
+                tree.host_sources[source_size * s + d] = src[source_size * sorder[s] + d];
+            }
+            position[sorder[s]] = s;
+        }
+        std::vector<double> remote(remote_width * m);
+        for (int q = 0; q < m; q++) {
+            for (int d = 0; d < remote_width; d++) {
+                remote[remote_width * q + d] = rem[remote_width * rorder[q] + d];
+            }
+        }
+
+        /* Bounding sphere of each cell, which holds the spheres of its
+         * remote cells as well as its sources */
+        int num_cells = links.size();
+        tree.host_geometry.resize(num_cells);
+        for (int c = 0; c < num_cells; c++) {
+            int begin = links[c][LINK_BEGIN], end = links[c][LINK_END];
+            int rbegin = links[c][LINK_REMOTE_BEGIN], rend = links[c][LINK_REMOTE_END];
+            auto & cell = tree.host_geometry[c];
+
+            double low[3], high[3], radius = 0.0;
+            for (int d = 0; d < 3; d++) {
+                low[d] = std::numeric_limits<double>::infinity();
+                high[d] = -low[d];
+            }
+            expandBox(tree.host_sources, source_size, nullptr, begin, end, low, high);
+            expandBox(remote, remote_width, nullptr, rbegin, rend, low, high);
+            for (int d = 0; d < 3; d++) cell[d] = (low[d] <= high[d]) ? 0.5 * (low[d] + high[d]) : 0.0;
+
+            for (int s = begin; s < end; s++) {
+                radius = std::max(radius, distance(&tree.host_sources[source_size * s], cell.data()));
+            }
+            for (int q = rbegin; q < rend; q++) {
+                const double * zq = &remote[remote_width * q];
+                radius = std::max(radius, distance(zq, cell.data()) + zq[3]);
+            }
+            cell[3] = radius;
+        }
+
+        int num_levels = depth.back() + 1;
+        tree.level_begin.assign(num_levels + 1, num_cells);
+        for (int c = num_cells - 1; c >= 0; c--) tree.level_begin[depth[c]] = c;
+
+        /* Flatten it all onto the device */
+        tree.geometry = cell_view(Kokkos::ViewAllocateWithoutInitializing("Tree geometry"),
+                                  num_cells, geometry_size);
+        tree.links = link_view(Kokkos::ViewAllocateWithoutInitializing("Tree links"),
+                               num_cells, link_size);
+        tree.sources = source_view(Kokkos::ViewAllocateWithoutInitializing("Tree sources"),
+                                   n, source_size);
+        tree.remote = source_view(Kokkos::ViewAllocateWithoutInitializing("Tree remote cells"),
+                                  m, remote_width);
+        auto h_geometry = Kokkos::create_mirror_view(tree.geometry);
+        auto h_links = Kokkos::create_mirror_view(tree.links);
+        auto h_sources = Kokkos::create_mirror_view(tree.sources);
+        auto h_remote = Kokkos::create_mirror_view(tree.remote);
+        for (int c = 0; c < num_cells; c++) {
+            for (int d = 0; d < geometry_size; d++) h_geometry(c, d) = tree.host_geometry[c][d];
+            for (int l = 0; l < link_size; l++) h_links(c, l) = links[c][l];
+        }
+        for (int s = 0; s < n; s++) {
+            for (int d = 0; d < source_size; d++) {
+                h_sources(s, d) = tree.host_sources[source_size * s + d];
+            }
+        }
+        for (int q = 0; q < m; q++) {
+            for (int d = 0; d < remote_width; d++) {
+                h_remote(q, d) = remote[remote_width * q + d];
+            }
+        }
+
+        Kokkos::deep_copy(tree.geometry, h_geometry);
+        Kokkos::deep_copy(tree.links, h_links);
+        Kokkos::deep_copy(tree.sources, h_sources);
+        Kokkos::deep_copy(tree.remote, h_remote);
+    }
+
+    /* Counting sort a range of items by octant around mid, leaving the
+     * number in each octant in count */
+    static void octantSort(const std::vector<double> & items, int stride, std::vector<int> & order,
+                           int begin, int end, const double mid[3], int count[8],
+                           std::vector<int> & scratch)
+    {
+        for (int o = 0; o < 8; o++) count[o] = 0;
+        for (int s = begin; s < end; s++) {
+            count[octant(&items[stride * order[s]], mid)]++;
+        }
+        int offset[8];
+        offset[0] = begin;
+        for (int o = 1; o < 8; o++) offset[o] = offset[o - 1] + count[o - 1];
+        for (int s = begin; s < end; s++) {
+            int o = octant(&items[stride * order[s]], mid);
+            scratch[offset[o]++] = order[s];
+        }
+        std::copy(scratch.begin() + begin, scratch.begin() + end, order.begin() + begin);
+    }
+
+    /* Grow a bounding box to hold the positions of a range of items, taken
+     * through order if it is given and in storage order otherwise */
+    static void expandBox(const std::vector<double> & items, int stride, const int * order,
+                          int begin, int end, double low[3], double high[3])
+    {
+        for (int s = begin; s < end; s++) {
+            const double * x = &items[stride * (order ? order[s] : s)];
+            for (int d = 0; d < 3; d++) {
+                low[d] = std::min(low[d], x[d]);
+                high[d] = std::max(high[d], x[d]);
+            }
+        }
+    }
+
+    static double distance(const double * x, const double * y)
+    {
+        double dist = 0.0;
+        for (int d = 0; d < 3; d++) {
+            dist += (x[d] - y[d]) * (x[d] - y[d]);
+        }
+        return std::sqrt(dist);
+    }
+
+    static int octant(const double * zs, const double mid[3])
+    {
+        return (zs[0] > mid[0]) | ((zs[1] > mid[1]) << 1) | ((zs[2] > mid[2]) << 2);
+    }
+
+    int _leaf_size;
+    MPI_Comm _comm;
+    int _num_procs, _rank;
+    BRSources<ExecutionSpace, MemorySpace> _sources;
+
+    source_view _own_sources;
+    std::vector<double> _host_own_sources;
+
+    /* Position of each owned source in the local tree and its inverse,
+     * and the radius of each local tree cell when it was built */
+    std::vector<int> _local_position;
+    index_view _local_order;
+    Kokkos::View<double*, device_type> _built_radius;
+    int _num_refits = 0, _num_builds = 0;
+
+    /* Bounding box of the points each process owns */
+    std::vector<double> _boxes;
+
+    /* Current local and essential trees */
+    Octree _local, _essential;
+    index_view _own_index;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_BRSOURCETREE_HPP
@@ -0,0 +1,173 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file BRSources.hpp
+ *
+ * @section DESCRIPTION
+ * The Birkhoff-Rott sources of the surface nodes a process owns, as seen by
+ * the far-field solvers. Each owned node is one source carrying its
+ * position and its vorticity vector with the Simpson quadrature weight and
+ * the constant BR scaling folded in, so that the solvers only do the
+ * distance and cross product work for each pair. Also says which periodic
+ * images of the sources a solver has to sum over.
+ */
+
+#ifndef BEATNIK_BRSOURCES_HPP
+#define BEATNIK_BRSOURCES_HPP
+
+// Include Statements
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <array>
+
+#include <BoundaryCondition.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The BRSources Class
+ * @class BRSources
+ * @brief Quadrature-weighted BR sources of the owned surface nodes
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class BRSources
+{
+  public:
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using mesh_type = Cabana::Grid::UniformMesh<double, 2>;
+
+    using Node = Cabana::Grid::Node;
+    using l2g_type = Cabana::Grid::IndexConversion::L2G<mesh_type, Node>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    /* Number of doubles stored for each source: position then weighted
+     * vorticity */
+    static constexpr int source_size = 6;
+
+    BRSources( const pm_type & pm, const BoundaryCondition & bc,
+               const double dx, const double dy )
+        : _pm( pm )
+        , _bc( bc )
+        , _dx( dx )
+        , _dy( dy )
+        , _local_L2G( *_pm.mesh().localGrid() )
+    {
+    }
+
+    /* Number of nodes owned by this process, and so number of sources it
+     * contributes */
+    int numOwned() const
+    {
+        int num_sources = 1;
+        for (int d = 0; d < 2; d++) {
+            num_sources *= _local_L2G.local_own_max[d] - _local_L2G.local_own_min[d];
+        }
+        return num_sources;
+    }
+
+    /* Figure out which directions we need to project source points to for
+     * any periodic boundary conditions, and how wide the bounding box we
+     * project them by is in each direction */
+    void periodicImages(Kokkos::Array<int, 2> & start, Kokkos::Array<int, 2> & end,
+                        Kokkos::Array<double, 3> & width) const
+    {
+        for (int d = 0; d < 2; d++) {
+            std::array<int, 2> dir = {0, 0};
+            dir[d] = 1;
+            if (_bc.isPeriodicBoundary(dir)) {
+                start[d] = -1; end[d] = 1;
+            } else {
+                start[d] = end[d] = 0;
+            }
+        }
+
+        auto low = _pm.mesh().boundingBoxMin();
+        auto high = _pm.mesh().boundingBoxMax();
+        for (int d = 0; d < 3; d++) {
+            width[d] = high[d] - low[d];
+        }
+    }
+
+    /* Weighted vorticity vector of node (k, l), whose global index is gi,
+     * on a surface of num_nodes nodes in each direction */
+    template <class ViewType>
+    static KOKKOS_INLINE_FUNCTION
+    void strength(double omega[3], ViewType z, ViewType w, int k, int l,
+                  const int gi[2], int num_nodes, double dx, double dy)
+    {
+        /* Compute Simpson's 3/8 quadrature weight for this index and fold
+         * it and the rest of the constant BR scaling into the vorticity */
+        double weight = Operators::simpsonWeight(gi[0], num_nodes)
+                            * Operators::simpsonWeight(gi[1], num_nodes);
+        weight *= (dx * dy) / (-4.0 * Kokkos::numbers::pi_v<double>);
+
+        for (int d = 0; d < 3; d++) {
+            omega[d] = weight * (w(k, l, 1) * Operators::Dx(z, k, l, d, dx)
+                               - w(k, l, 0) * Operators::Dy(z, k, l, d, dy));
+        }
+    }
+
+    /* Compute the source of every owned node on the given execution space
+     * instance. Source s is owned node (kmin + s / lwidth, lmin + s % lwidth)
+     * and holds its position in entries 0-2 and its weighted vorticity
+     * vector in entries 3-5. */
+    template <class SourceView>
+    void compute(const ExecutionSpace & exec, SourceView sources,
+                 node_view z, node_view w) const
+    {
+        auto L2G = _local_L2G;
+        std::array<long, 2> rmin, rmax;
+        for (int d = 0; d < 2; d++) {
+            rmin[d] = L2G.local_own_min[d];
+            rmax[d] = L2G.local_own_max[d];
+        }
+        Cabana::Grid::IndexSpace<2> block_space(rmin, rmax);
+
+        double dx = _dx, dy = _dy;
+        int kmin = rmin[0], lmin = rmin[1];
+        int lwidth = rmax[1] - rmin[1];
+        int num_nodes = _pm.mesh().get_mesh_size();
+
+        Kokkos::parallel_for("BR Source Strengths",
+            Cabana::Grid::createExecutionPolicy(block_space, exec),
+            KOKKOS_LAMBDA(int k, int l) {
+            // We need the global indicies of the (k, l) point for Simpson's weight
+            int li[2] = {k, l};
+            int gi[2] = {0, 0};
+            L2G(li, gi);
+
+            double omega[3];
+            strength(omega, z, w, k, l, gi, num_nodes, dx, dy);
+
+            int s = (k - kmin) * lwidth + (l - lmin);
+            for (int d = 0; d < 3; d++) {
+                sources(s, d) = z(k, l, d);
+                sources(s, d + 3) = omega[d];
+            }
+        });
+    }
+
+  private:
+    const pm_type & _pm;
+    const BoundaryCondition & _bc;
+    double _dx, _dy;
+    l2g_type _local_L2G;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_BRSOURCES_HPP
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file CutoffBRSolver.hpp
+ *
+ * @section DESCRIPTION
+ * Class that approximates the Birkhoff-Rott velocity integral by only
+ * summing the contributions of interface points within a cutoff distance.
+ * The interface points are migrated into a spatial decomposition of the
+ * problem domain as Cabana particles, points within the cutoff of other
+ * processes (or of a periodic image) are ghosted to them, and a Cabana
+ * Verlet neighbor list finds each point's neighbors. The velocities are
+ * then sent back to the processes owning the points in the surface mesh.
+ */
+
+#ifndef BEATNIK_CUTOFFBRSOLVER_HPP
+#define BEATNIK_CUTOFFBRSOLVER_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <ostream>
+#include <stdexcept>
+
+#include <BRSolverBase.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+#include <SolverParams.hpp>
+#include <SpatialMesh.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The CutoffBRSolver Class
+ * @class CutoffBRSolver
+ * @brief Approximates the Birkhoff-Rott integral with the contributions of
+ * points within a cutoff distance, found with Cabana neighbor lists
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class CutoffBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
+{
+  public:
+    using exec_space = ExecutionSpace;
+    using memory_space = MemorySpace;
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    using spatial_mesh_type = SpatialMesh<ExecutionSpace, MemorySpace>;
+    using particle_type = typename spatial_mesh_type::particle_type;
+    using list_type = typename spatial_mesh_type::neighbor_list_type;
+
+    CutoffBRSolver( const pm_type & pm, const BoundaryCondition &bc,
+                    const double epsilon, const double dx, const double dy,
+                    const SolverParams & params = SolverParams() )
+        : _epsilon( epsilon )
+        , _cutoff( params.br_cutoff )
+        , _spatial( pm, bc, dx, dy, params.br_cutoff, 1 )
+        , _particles( "Cutoff BR particles" )
+    {
+        if (_cutoff <= 0.0) {
+            throw std::invalid_argument("Invalid BR cutoff distance");
+        }
+    }
+
+    /* Compute the interface velocities from the points within the cutoff */
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        double start = MPI_Wtime();
+        Kokkos::Profiling::pushRegion("Cutoff BR Distribute");
+        _spatial.createParticles(z, w, _particles);
+        _spatial.migrate(_particles);
+        int num_owned = _spatial.addGhosts(_particles, _cutoff);
+        Kokkos::Profiling::popRegion();
+        double distributed = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("Cutoff BR Neighbors");
+        auto list = _spatial.createNeighborList(_particles, num_owned, _cutoff);
+        auto x = Cabana::slice<spatial_mesh_type::Position>(_particles);
+        auto omega = Cabana::slice<spatial_mesh_type::Vorticity>(_particles);
+        auto u = Cabana::slice<spatial_mesh_type::Velocity>(_particles);
+        Kokkos::Profiling::popRegion();
+        double listed = MPI_Wtime();
+
+        /* Each owned particle sums over its own neighbors, so no atomics */
+        Kokkos::Profiling::pushRegion("Cutoff BR Compute");
+        double epsilon = _epsilon;
+        Kokkos::parallel_for("Cutoff BR Force Loop",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            double zi[3], brsum[3] = {0.0, 0.0, 0.0};
+            double offset[3] = {0.0, 0.0, 0.0};
+            for (int d = 0; d < 3; d++) zi[d] = x(p, d);
+
+            int num_neighbors = Cabana::NeighborList<list_type>::numNeighbor(list, p);
+            for (int n = 0; n < num_neighbors; n++) {
+                int q = Cabana::NeighborList<list_type>::getNeighbor(list, p, n);
+                double zq[3], wq[3], br[3];
+                for (int d = 0; d < 3; d++) {
+                    zq[d] = x(q, d);
+                    wq[d] = omega(q, d);
+                }
+                Operators::BR(br, zi, zq, wq, epsilon, offset);
+                for (int d = 0; d < 3; d++) brsum[d] += br[d];
+            }
+            for (int d = 0; d < 3; d++) u(p, d) = brsum[d];
+        });
+        Kokkos::Profiling::popRegion();
+        double computed = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("Cutoff BR Return");
+        _spatial.returnVelocities(_particles, num_owned, zdot);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double returned = MPI_Wtime();
+
+        _comm_time += (distributed - start) + (returned - computed);
+        _list_time += listed - distributed;
+        _compute_time += computed - listed;
+        _samples++;
+    }
+
+    /* Print the time spent moving particles, building neighbor lists and
+     * computing, taking the maximum across processes */
+    void printTimings(std::ostream & out) const override
+    {
+        if (_samples == 0) return;
+
+        double local[3] = {_comm_time, _list_time, _compute_time}, global[3];
+        MPI_Reduce(local, global, 3, MPI_DOUBLE, MPI_MAX, 0, _spatial.comm());
+        if (_spatial.rank() != 0) return;
+
+        out << "===== Cutoff BR Timings (max over ranks) =====\n"
+            << "Communication: " << global[0] << " s, neighbor lists " << global[1]
+            << " s, compute " << global[2] << " s over " << _samples
+            << " calls (cutoff " << _cutoff << ")\n"
+            << "==============================================\n";
+    }
+
+  private:
+    double _epsilon;
+    double _cutoff;
+    spatial_mesh_type _spatial;
+    mutable particle_type _particles;
+
+    mutable double _comm_time = 0.0, _list_time = 0.0, _compute_time = 0.0;
+    mutable int _samples = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_CUTOFFBRSOLVER_HPP
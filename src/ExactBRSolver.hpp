@@ -18,9 +18,15 @@
  * @section DESCRIPTION
  * Class that uses a brute force approach to calculating the Birkhoff-Rott 
  * velocity intergral by using a all-pairs approach. Communication
- * uses a standard ring-pass communication algorithm. Does not attempt to 
- * reduce amount of computation per ring pass by using symetry of forces
- * as this complicates the GPU kernel.
+ * uses a standard ring-pass communication algorithm. By default it does not 
+ * attempt to reduce amount of computation per ring pass by using symetry of
+ * forces as this complicates the GPU kernel, but a symmetric variant that 
+ * evaluates each pair once and returns the reciprocal velocities to the 
+ * owning process over a half-length ring can be selected. The non-symmetric
+ * pass can use a flat kernel over all point/source pairs with atomic
+ * accumulation, a hierarchical kernel that reduces over sources per point,
+ * a cache-blocked kernel that stages source tiles in scratch memory, or an
+ * explicitly vectorized kernel on host execution spaces.
  */
 
 #ifndef BEATNIK_EXACTBRSOLVER_HPP
@@ -34,12 +40,54 @@
 #include <Cabana_Core.hpp>
 #include <Cabana_Grid.hpp>
 #include <Kokkos_Core.hpp>
+#include <Kokkos_SIMD.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
 
+#include <BRSolverBase.hpp>
+#include <BRSources.hpp>
 #include <Mesh.hpp>
 #include <ProblemManager.hpp>
 #include <Operators.hpp>
+#include <SolverParams.hpp>
+
+namespace Beatnik
+{
+
+/* Velocity sum reduced over the sources by a team in the team BR kernel */
+struct BRVelocitySum
+{
+    double v[3];
+
+    KOKKOS_INLINE_FUNCTION BRVelocitySum() 
+    {
+        v[0] = v[1] = v[2] = 0.0;
+    }
+
+    KOKKOS_INLINE_FUNCTION BRVelocitySum & operator+=(const BRVelocitySum & other)
+    {
+        for (int d = 0; d < 3; d++) v[d] += other.v[d];
+        return *this;
+    }
+};
+
+} // namespace Beatnik
+
+namespace Kokkos
+{
+template <>
+struct reduction_identity<Beatnik::BRVelocitySum>
+{
+    KOKKOS_FORCEINLINE_FUNCTION static Beatnik::BRVelocitySum sum()
+    {
+        return Beatnik::BRVelocitySum();
+    }
+};
+} // namespace Kokkos
 
 namespace Beatnik
 {
@@ -51,7 +99,7 @@ namespace Beatnik
  * all-pairs calculation
  **/
 template <class ExecutionSpace, class MemorySpace>
-class ExactBRSolver
+class ExactBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
 {
   public:
     using exec_space = ExecutionSpace;
@@ -65,110 +113,163 @@ class ExactBRSolver
     using node_array = typename pm_type::node_array;
     //using node_view = typename pm_type::node_view;
     using node_view = Kokkos::View<double***, device_type>;
+    using atomic_node_view = Kokkos::View<double***, device_type,
+                                          Kokkos::MemoryTraits<Kokkos::Atomic>>;
+
+    /* Contiguous ring-pass message buffer, and the compact per-source 
+     * position and weighted vorticity stored in it. Sources are stored 
+     * structure-of-arrays so that consecutive sources are contiguous */
+    using buffer_view = Kokkos::View<double*, device_type>;
+    using source_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type,
+                                     Kokkos::MemoryUnmanaged>;
+    using atomic_source_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type,
+        Kokkos::MemoryTraits<Kokkos::Unmanaged | Kokkos::Atomic>>;
 
     using halo_type = Cabana::Grid::Halo<MemorySpace>;
 
     ExactBRSolver( const pm_type & pm, const BoundaryCondition &bc,
-                   const double epsilon, const double dx, const double dy)
+                   const double epsilon, const double dx, const double dy,
+                   const SolverParams & params = SolverParams() )
         : _pm( pm )
-        , _bc( bc )
         , _epsilon( epsilon )
-        , _dx( dx )
-        , _dy( dy )
+        , _symmetric( params.br_symmetric )
+        , _kernel( params.br_kernel )
+        , _exec( Kokkos::Experimental::partition_space(ExecutionSpace(), 1)[0] )
         , _local_L2G( *_pm.mesh().localGrid() )
+        , _sources( pm, bc, dx, dy )
     {
 	_comm = _pm.mesh().localGrid()->globalGrid().comm();
+        MPI_Comm_size(_comm, &_num_procs);
+        MPI_Comm_rank(_comm, &_rank);
+
+        /* The decomposition never changes, so exchange how many sources each
+         * process owns once and set up the ring-pass buffers, sized for the 
+         * largest block, here rather than on every ring pass. */
+        int num_sources = _sources.numOwned();
+        _block_sources.resize(_num_procs);
+        MPI_Allgather(&num_sources, 1, MPI_INT, _block_sources.data(), 1, MPI_INT, _comm);
+        int max_sources = *std::max_element(_block_sources.begin(), _block_sources.end());
+        int max_message = source_size * max_sources;
+
+        _message1 = buffer_view(Kokkos::ViewAllocateWithoutInitializing("BR message1"), max_message);
+        _message2 = buffer_view(Kokkos::ViewAllocateWithoutInitializing("BR message2"), max_message);
+
+        /* The symmetric variant keeps our own block around for the whole pass
+         * and also needs buffers for the velocities it returns to the owners
+         * of the remote blocks. Those are still in flight during the next
+         * step, so there are two of each that alternate between steps. */
+        if (_symmetric) {
+            _message3 = buffer_view(Kokkos::ViewAllocateWithoutInitializing("BR message3"), max_message);
+            for (int b = 0; b < 2; b++) {
+                _return_send[b] = buffer_view("BR return send", 3 * max_sources);
+                _return_recv[b] = buffer_view("BR return recv", 3 * max_sources);
+            }
+        }
+
+        _ring_timings.assign(_num_procs, RingStepTiming());
     }
 
-    static KOKKOS_INLINE_FUNCTION double simpsonWeight(int index, int len)
+    /* Number of doubles stored for each source in a ring-pass message */
+    static constexpr int source_size = BRSources<ExecutionSpace, MemorySpace>::source_size;
+
+    /* Number of points each team of the tiled kernel owns and number of 
+     * sources in each tile it stages in scratch memory. A source tile is 
+     * 12KB, so it stays resident in L1 on the hosts we run on. */
+    static constexpr int tile_points = 64;
+    static constexpr int tile_sources = 256;
+
+    /* Get the sources stored in a packed ring-pass message */
+    static source_view messageSources(buffer_view message, int num_sources)
     {
-        if (index == (len - 1) || index == 0) return 3.0/8.0;
-        else if (index % 3 == 0) return 3.0/4.0;
-        else return 9.0/8.0;
+        return source_view(message.data(), num_sources, source_size);
     }
 
-    template <class AtomicView>
-    void computeInterfaceVelocityPiece(AtomicView atomic_zdot, node_view z, 
-                                       node_view zremote, node_view wremote, 
-                                       l2g_type remote_L2G) const
+    /* Compute the position and quadrature-weighted vorticity vector of every 
+     * owned node once and pack them into a contiguous message, so that the 
+     * all-pairs loop only has to do the distance and cross product work for
+     * each pair and only owned data is sent around the ring. */
+    void computeSourceStrengths(buffer_view message, node_view z, node_view w) const
     {
-        /* Project the Birkhoff-Rott calculation between all pairs of points on the 
-         * interface, including accounting for any periodic boundary conditions.
-         * Right now we brute force all of the points with no tiling to improve
-         * memory access or optimizations to remove duplicate calculations. */
+        _sources.compute(_exec, messageSources(message, _block_sources[_rank]), z, w);
+    }
+
+    /* Project the Birkhoff-Rott calculation between all pairs of points on the 
+     * interface, including accounting for any periodic boundary conditions,
+     * using the configured kernel. Duplicate per-source calculations are 
+     * removed by having the owner of each source compute its strength once. */
+    void computeInterfaceVelocityPiece(node_view zdot, node_view z, 
+                                       buffer_view message, int num_sources) const
+    {
+        switch (_kernel) {
+        case BR_KERNEL_FLAT:
+            computeFlatPiece(zdot, z, message, num_sources);
+            break;
+        case BR_KERNEL_TILED:
+            computeTiledPiece(zdot, z, message, num_sources);
+            break;
+        case BR_KERNEL_SIMD:
+            computeSimdPiece(zdot, z, message, num_sources);
+            break;
+        case BR_KERNEL_TEAM:
+        default:
+            computeTeamPiece(zdot, z, message, num_sources);
+            break;
+        }
+    }
+
+    /* Brute force all of the pairs with one thread per point/source pair 
+     * and no tiling to improve memory access. Every source of a point adds
+     * to its velocity, so the accumulation has to be atomic. */
+    void computeFlatPiece(node_view zdot, node_view z, 
+                          buffer_view message, int num_sources) const
+    {
+        Kokkos::View<double ***,
+             typename node_view::device_type,
+             Kokkos::MemoryTraits<Kokkos::Atomic>> atomic_zdot = zdot;
 
         // Get the local index spaces of pieces we're working with. For the local surface piece
-        // this is just the nodes we own. For the remote surface piece, we extract it from the
-        // L2G converter they sent us.
+        // this is just the nodes we own. For the remote surface piece, it is the list of 
+        // sources packed into the message we were sent.
         auto local_grid = _pm.mesh().localGrid();
         auto local_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
-        std::array<long, 2> rmin, rmax;
-        for (int d = 0; d < 2; d++) {
-            rmin[d] = remote_L2G.local_own_min[d];
-            rmax[d] = remote_L2G.local_own_max[d];
-        }
-	Cabana::Grid::IndexSpace<2> remote_space(rmin, rmax);
+        auto sources = messageSources(message, num_sources);
 
         /* Figure out which directions we need to project the k/l point to
          * for any periodic boundary conditions */
-        int kstart, lstart, kend, lend;
-        if (_bc.isPeriodicBoundary({0, 1})) {
-            kstart = -1; kend = 1;
-        } else {
-            kstart = kend = 0;
-        }
-        if (_bc.isPeriodicBoundary({1, 1})) {
-            lstart = -1; lend = 1;
-        } else {
-            lstart = lend = 0;
-        }
-
-        /* Figure out how wide the bounding box is in each direction */
-        auto low = _pm.mesh().boundingBoxMin();
-        auto high = _pm.mesh().boundingBoxMax();;
-        double width[3];
-        for (int d = 0; d < 3; d++) {
-            width[d] = high[d] - low[d];
-        }
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
 
         /* Local temporaries for any instance variables we need so that we
          * don't have to lambda-capture "this" */
         double epsilon = _epsilon;
-        double dx = _dx, dy = _dy;
-
-        // Mesh dimensions for Simpson weight calc
-        int num_nodes = _pm.mesh().get_mesh_size();
 
-        /* Now loop over the cross product of all the node on the interface */
-        auto pair_space = Operators::crossIndexSpace(local_space, remote_space);
+        /* Now loop over the cross product of all the owned nodes and the 
+         * remote sources */
+        Cabana::Grid::IndexSpace<1> source_space({0}, {num_sources});
+        auto pair_space = Operators::crossIndexSpace(local_space, source_space);
         Kokkos::parallel_for("Exact BR Force Loop",
-            Cabana::Grid::createExecutionPolicy(pair_space, ExecutionSpace()),
-            KOKKOS_LAMBDA(int i, int j, int k, int l) {
-
-            // We need the global indicies of the (k, l) point for Simpson's weight
-            int remote_li[2] = {k, l};
-            int remote_gi[2] = {0, 0};  // k, l
-            remote_L2G(remote_li, remote_gi);
-            
+            Cabana::Grid::createExecutionPolicy(pair_space, _exec),
+            KOKKOS_LAMBDA(int i, int j, int s) {
             double brsum[3] = {0.0, 0.0, 0.0};
-
-            /* Compute Simpson's 3/8 quadrature weight for this index */
-            double weight;
-            weight = simpsonWeight(remote_gi[0], num_nodes)
-                        * simpsonWeight(remote_gi[1], num_nodes);
+            double zi[3], zs[3], omega[3];
+            for (int d = 0; d < 3; d++) {
+                zi[d] = z(i, j, d);
+                zs[d] = sources(s, d);
+                omega[d] = sources(s, d + 3);
+            }
             
             /* We already have N^4 parallelism, so no need to parallelize on 
              * the BR periodic points. Instead we serialize this in each thread
              * and reuse the fetch of the i/j and k/l points */
-            for (int kdir = kstart; kdir <= kend; kdir++) {
-                for (int ldir = lstart; ldir <= lend; ldir++) {
+            for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                for (int ldir = start[1]; ldir <= end[1]; ldir++) {
                     double offset[3] = {0.0, 0.0, 0.0}, br[3];
                     offset[0] = kdir * width[0];
                     offset[1] = ldir * width[1];
 
                     /* Do the Birkhoff-Rott evaluation for this point */
-                    Operators::BR(br, z, zremote, wremote, epsilon, dx, dy, weight,
-                                  i, j, k, l, offset);
+                    Operators::BR(br, zi, zs, omega, epsilon, offset);
                     for (int d = 0; d < 3; d++) {
                         brsum[d] += br[d];
                     }
@@ -182,19 +283,538 @@ class ExactBRSolver
         });
     }
 
+    /* Hierarchical version of the all-pairs loop. Each team owns a single 
+     * point and its threads reduce over the sources, so the only write to 
+     * the interface velocity is one plain add per point per block instead 
+     * of an atomic add per pair. */
+    void computeTeamPiece(node_view zdot, node_view z, 
+                          buffer_view message, int num_sources) const
+    {
+        using team_policy = Kokkos::TeamPolicy<ExecutionSpace>;
+        using member_type = typename team_policy::member_type;
+
+        auto local_grid = _pm.mesh().localGrid();
+        auto local_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto sources = messageSources(message, num_sources);
+
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
+
+        double epsilon = _epsilon;
+        int imin = local_space.min(0), jmin = local_space.min(1);
+        int jwidth = local_space.extent(1);
+        int num_points = local_space.size();
+
+        Kokkos::parallel_for("Exact BR Team Force Loop",
+            team_policy(_exec, num_points, Kokkos::AUTO),
+            KOKKOS_LAMBDA(const member_type & team) {
+            int t = team.league_rank();
+            int i = imin + t / jwidth, j = jmin + t % jwidth;
+            double zi[3];
+            for (int d = 0; d < 3; d++) {
+                zi[d] = z(i, j, d);
+            }
+
+            BRVelocitySum brsum;
+            Kokkos::parallel_reduce(Kokkos::TeamThreadRange(team, num_sources),
+                [&](const int s, BRVelocitySum & lsum) {
+                double zs[3], omega[3];
+                for (int d = 0; d < 3; d++) {
+                    zs[d] = sources(s, d);
+                    omega[d] = sources(s, d + 3);
+                }
+                for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                    for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                        double offset[3] = {0.0, 0.0, 0.0}, br[3];
+                        offset[0] = kdir * width[0];
+                        offset[1] = ldir * width[1];
+                        Operators::BR(br, zi, zs, omega, epsilon, offset);
+                        for (int d = 0; d < 3; d++) {
+                            lsum.v[d] += br[d];
+                        }
+                    }
+                }
+            }, brsum);
+
+            /* The team owns this point, so a single thread adds the block's 
+             * contribution without any atomics */
+            Kokkos::single(Kokkos::PerTeam(team), [&]() {
+                for (int n = 0; n < 3; n++) {
+                    zdot(i, j, n) += brsum.v[n];
+                }
+            });
+        });
+    }
+
+    /* Cache-blocked version of the all-pairs loop. Each team owns a block of
+     * points and walks the sources a tile at a time, staging each tile in 
+     * team scratch memory so that it is read from main memory once and then
+     * reused by every point in the block. Only the owning team writes its 
+     * points, so the velocity is again accumulated without atomics. */
+    void computeTiledPiece(node_view zdot, node_view z, 
+                           buffer_view message, int num_sources) const
+    {
+        using team_policy = Kokkos::TeamPolicy<ExecutionSpace>;
+        using member_type = typename team_policy::member_type;
+        using scratch_view = Kokkos::View<double**, Kokkos::LayoutLeft,
+            typename ExecutionSpace::scratch_memory_space, Kokkos::MemoryUnmanaged>;
+
+        auto local_grid = _pm.mesh().localGrid();
+        auto local_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto sources = messageSources(message, num_sources);
+
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
+
+        double epsilon = _epsilon;
+        int imin = local_space.min(0), jmin = local_space.min(1);
+        int jwidth = local_space.extent(1);
+        int num_points = local_space.size();
+        int num_blocks = (num_points + tile_points - 1) / tile_points;
+        int num_tiles = (num_sources + tile_sources - 1) / tile_sources;
+
+        team_policy policy(_exec, num_blocks, Kokkos::AUTO);
+        policy.set_scratch_size(0, Kokkos::PerTeam(
+            scratch_view::shmem_size(tile_sources, source_size)));
+
+        Kokkos::parallel_for("Exact BR Tiled Force Loop", policy,
+            KOKKOS_LAMBDA(const member_type & team) {
+            scratch_view tile(team.team_scratch(0), tile_sources, source_size);
+            int first = team.league_rank() * tile_points;
+            int npoints = Kokkos::min(tile_points, num_points - first);
+
+            for (int b = 0; b < num_tiles; b++) {
+                int sbase = b * tile_sources;
+                int nsources = Kokkos::min(tile_sources, num_sources - sbase);
+
+                /* Stage the tile, making sure nobody is still using the last one */
+                team.team_barrier();
+                Kokkos::parallel_for(Kokkos::TeamThreadRange(team, nsources), [&](const int s) {
+                    for (int d = 0; d < source_size; d++) {
+                        tile(s, d) = sources(sbase + s, d);
+                    }
+                });
+                team.team_barrier();
+
+                Kokkos::parallel_for(Kokkos::TeamThreadRange(team, npoints), [&](const int p) {
+                    int t = first + p;
+                    int i = imin + t / jwidth, j = jmin + t % jwidth;
+                    double brsum[3] = {0.0, 0.0, 0.0};
+                    double zi[3];
+                    for (int d = 0; d < 3; d++) {
+                        zi[d] = z(i, j, d);
+                    }
+                    for (int s = 0; s < nsources; s++) {
+                        double zs[3], omega[3];
+                        for (int d = 0; d < 3; d++) {
+                            zs[d] = tile(s, d);
+                            omega[d] = tile(s, d + 3);
+                        }
+                        for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                            for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                                double offset[3] = {0.0, 0.0, 0.0}, br[3];
+                                offset[0] = kdir * width[0];
+                                offset[1] = ldir * width[1];
+                                Operators::BR(br, zi, zs, omega, epsilon, offset);
+                                for (int d = 0; d < 3; d++) {
+                                    brsum[d] += br[d];
+                                }
+                            }
+                        }
+                    }
+                    for (int n = 0; n < 3; n++) {
+                        zdot(i, j, n) += brsum[n];
+                    }
+                });
+            }
+        });
+    }
+
+    /* Explicitly vectorized version of the all-pairs loop for host execution
+     * spaces. Each thread owns a point and evaluates a SIMD vector of sources
+     * at a time, loading them directly from the structure-of-arrays message.
+     * The desingularized denominator is computed from one reciprocal square
+     * root instead of pow(). That is a full precision square root and
+     * divide rather than an approximate rsqrt refined by a Newton step:
+     * Kokkos SIMD has no portable approximate rsqrt, and this solver is the
+     * reference the approximate solvers are checked against, so all of its
+     * kernels have to agree to roundoff. Sources left over after the last
+     * full vector are summed one at a time. Device execution spaces use the
+     * team kernel. */
+    void computeSimdPiece(node_view zdot, node_view z, 
+                          buffer_view message, int num_sources) const
+    {
+        if constexpr (!Kokkos::SpaceAccessibility<ExecutionSpace, Kokkos::HostSpace>::accessible) {
+            computeTeamPiece(zdot, z, message, num_sources);
+        } else {
+            using simd_type = Kokkos::Experimental::native_simd<double>;
+            using tag_type = Kokkos::Experimental::element_aligned_tag;
+            constexpr int lanes = simd_type::size();
+
+            auto local_grid = _pm.mesh().localGrid();
+            auto local_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+
+            Kokkos::Array<int, 2> start, end;
+            Kokkos::Array<double, 3> width;
+            _sources.periodicImages(start, end, width);
+
+            double epsilon = _epsilon;
+            int imin = local_space.min(0), jmin = local_space.min(1);
+            int jwidth = local_space.extent(1);
+            int num_points = local_space.size();
+            int num_vector = num_sources - num_sources % lanes;
+
+            /* Source component d is the contiguous column starting at 
+             * d * num_sources in the message */
+            const double * src = message.data();
+
+            // Host-only lambda, so the SIMD types never need a device version
+            Kokkos::parallel_for("Exact BR SIMD Force Loop",
+                Kokkos::RangePolicy<ExecutionSpace>(_exec, 0, num_points),
+                [=](const int t) {
+                int i = imin + t / jwidth, j = jmin + t % jwidth;
+                simd_type vsum[3] = {simd_type(0.0), simd_type(0.0), simd_type(0.0)};
+                double brsum[3] = {0.0, 0.0, 0.0};
+
+                for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                    for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                        /* Move the point rather than the sources by the 
+                         * periodic offset */
+                        double zi[3] = {z(i, j, 0) - kdir * width[0],
+                                        z(i, j, 1) - ldir * width[1],
+                                        z(i, j, 2)};
+
+                        for (int s = 0; s < num_vector; s += lanes) {
+                            simd_type zdiff[3], omega[3];
+                            for (int d = 0; d < 3; d++) {
+                                zdiff[d].copy_from(src + d * num_sources + s, tag_type());
+                                zdiff[d] = simd_type(zi[d]) - zdiff[d];
+                                omega[d].copy_from(src + (d + 3) * num_sources + s, tag_type());
+                            }
+                            simd_type r2 = zdiff[0] * zdiff[0] + zdiff[1] * zdiff[1]
+                                         + zdiff[2] * zdiff[2] + simd_type(epsilon);
+                            simd_type rinv = simd_type(1.0) / Kokkos::sqrt(r2);
+                            simd_type rinv3 = rinv * rinv * rinv;
+                            vsum[0] = vsum[0] + (omega[1] * zdiff[2] - omega[2] * zdiff[1]) * rinv3;
+                            vsum[1] = vsum[1] + (omega[2] * zdiff[0] - omega[0] * zdiff[2]) * rinv3;
+                            vsum[2] = vsum[2] + (omega[0] * zdiff[1] - omega[1] * zdiff[0]) * rinv3;
+                        }
+
+                        // Remainder sources that don't fill a vector
+                        for (int s = num_vector; s < num_sources; s++) {
+                            double zs[3], omega[3], br[3];
+                            double offset[3] = {0.0, 0.0, 0.0};
+                            for (int d = 0; d < 3; d++) {
+                                zs[d] = src[d * num_sources + s];
+                                omega[d] = src[(d + 3) * num_sources + s];
+                            }
+                            Operators::BR(br, zi, zs, omega, epsilon, offset);
+                            for (int d = 0; d < 3; d++) {
+                                brsum[d] += br[d];
+                            }
+                        }
+                    }
+                }
+
+                for (int d = 0; d < 3; d++) {
+                    double lane_sums[lanes];
+                    vsum[d].copy_to(lane_sums, tag_type());
+                    for (int l = 0; l < lanes; l++) {
+                        brsum[d] += lane_sums[l];
+                    }
+                    zdot(i, j, d) += brsum[d];
+                }
+            });
+        }
+    }
+
+    /* Compute the interactions between the sources in our own block and a
+     * remote block, adding the velocity induced on our nodes to the 
+     * interface velocity. If reciprocal, each pair is evaluated once and the 
+     * velocity our sources induce on the remote nodes is also accumulated 
+     * into the given return buffer for the owner of the remote block. */
+    template <class AtomicView>
+    void computeSymmetricPiece(AtomicView atomic_zdot, buffer_view own_message,
+                               buffer_view remote_message, int num_remote, 
+                               buffer_view return_message, bool reciprocal) const
+    {
+        int num_own = _block_sources[_rank];
+        auto own = messageSources(own_message, num_own);
+        auto remote = messageSources(remote_message, num_remote);
+        atomic_source_view returned(return_message.data(), num_remote, 3);
+
+        // Own source s corresponds to owned node (imin + s / jwidth, jmin + s % jwidth)
+        int imin = _local_L2G.local_own_min[0], jmin = _local_L2G.local_own_min[1];
+        int jwidth = _local_L2G.local_own_max[1] - jmin;
+
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
+        double epsilon = _epsilon;
+
+        Cabana::Grid::IndexSpace<2> pair_space({0, 0}, {num_own, num_remote});
+        Kokkos::parallel_for("Exact BR Symmetric Force Loop",
+            Cabana::Grid::createExecutionPolicy(pair_space, _exec),
+            KOKKOS_LAMBDA(int t, int s) {
+            double zt[3], zs[3], omegat[3], omegas[3];
+            double ut[3] = {0.0, 0.0, 0.0}, us[3] = {0.0, 0.0, 0.0};
+            for (int d = 0; d < 3; d++) {
+                zt[d] = own(t, d);
+                omegat[d] = own(t, d + 3);
+                zs[d] = remote(s, d);
+                omegas[d] = remote(s, d + 3);
+            }
+
+            for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                    double offset[3] = {0.0, 0.0, 0.0}, bt[3], bs[3];
+                    offset[0] = kdir * width[0];
+                    offset[1] = ldir * width[1];
+                    if (reciprocal) {
+                        Operators::BRPair(bt, bs, zt, zs, omegat, omegas, epsilon, offset);
+                        for (int d = 0; d < 3; d++) {
+                            ut[d] += bt[d];
+                            us[d] += bs[d];
+                        }
+                    } else {
+                        Operators::BR(bt, zt, zs, omegas, epsilon, offset);
+                        for (int d = 0; d < 3; d++) {
+                            ut[d] += bt[d];
+                        }
+                    }
+                }
+            }
+
+            int i = imin + t / jwidth, j = jmin + t % jwidth;
+            for (int d = 0; d < 3; d++) {
+                atomic_zdot(i, j, d) += ut[d];
+            }
+            if (reciprocal) {
+                for (int d = 0; d < 3; d++) {
+                    returned(s, d) += us[d];
+                }
+            }
+        });
+    }
+
+    /* Compute the interactions between all pairs of sources in our own block,
+     * evaluating each pair of distinct nodes once */
+    template <class AtomicView>
+    void computeSymmetricSelfPiece(AtomicView atomic_zdot, buffer_view own_message) const
+    {
+        int num_own = _block_sources[_rank];
+        auto own = messageSources(own_message, num_own);
+
+        int imin = _local_L2G.local_own_min[0], jmin = _local_L2G.local_own_min[1];
+        int jwidth = _local_L2G.local_own_max[1] - jmin;
+
+        Kokkos::Array<int, 2> start, end;
+        Kokkos::Array<double, 3> width;
+        _sources.periodicImages(start, end, width);
+        double epsilon = _epsilon;
+
+        /* Only launch the pairs a <= b, numbered row by row down the lower
+         * triangle so that pair p is in row b = (sqrt(8p + 1) - 1) / 2.
+         * The count overflows an int for blocks of more than 64K nodes. */
+        long num_pairs = long(num_own) * (num_own + 1) / 2;
+        Kokkos::parallel_for("Exact BR Symmetric Self Loop",
+            Kokkos::RangePolicy<ExecutionSpace, Kokkos::IndexType<long>>(_exec, 0, num_pairs),
+            KOKKOS_LAMBDA(const long p) {
+            long row = long((Kokkos::sqrt(8.0 * double(p) + 1.0) - 1.0) / 2.0);
+            // Correct for any rounding in the square root
+            while (row * (row + 1) / 2 > p) row--;
+            while ((row + 1) * (row + 2) / 2 <= p) row++;
+            int b = int(row);
+            int a = int(p - row * (row + 1) / 2);
+
+            double za[3], zb[3], omegaa[3], omegab[3];
+            double ua[3] = {0.0, 0.0, 0.0}, ub[3] = {0.0, 0.0, 0.0};
+            for (int d = 0; d < 3; d++) {
+                za[d] = own(a, d);
+                omegaa[d] = own(a, d + 3);
+                zb[d] = own(b, d);
+                omegab[d] = own(b, d + 3);
+            }
+
+            /* A node only interacts with the periodic images of itself, and 
+             * the loop over images already covers both directions of that */
+            for (int kdir = start[0]; kdir <= end[0]; kdir++) {
+                for (int ldir = start[1]; ldir <= end[1]; ldir++) {
+                    double offset[3] = {0.0, 0.0, 0.0}, ba[3], bb[3];
+                    offset[0] = kdir * width[0];
+                    offset[1] = ldir * width[1];
+                    Operators::BRPair(ba, bb, za, zb, omegaa, omegab, epsilon, offset);
+                    for (int d = 0; d < 3; d++) {
+                        ua[d] += ba[d];
+                        ub[d] += bb[d];
+                    }
+                }
+            }
+
+            int ia = imin + a / jwidth, ja = jmin + a % jwidth;
+            int ib = imin + b / jwidth, jb = jmin + b % jwidth;
+            for (int d = 0; d < 3; d++) {
+                atomic_zdot(ia, ja, d) += ua[d];
+            }
+            if (a != b) {
+                for (int d = 0; d < 3; d++) {
+                    atomic_zdot(ib, jb, d) += ub[d];
+                }
+            }
+        });
+    }
+
+    /* Start step s of a symmetric ring pass. Step s of the half-length ring
+     * computes the interactions between our block and the block of rank - s
+     * in both directions and returns the velocities induced on its nodes to
+     * rank - s, while receiving those induced on our nodes from rank + s. 
+     * Step 0 computes the interactions within our own block. With an even 
+     * number of processes, the final step pairs each process with the one 
+     * directly across the ring, so both sides compute their own half of that
+     * step instead of returning anything. Our own block stays in _message1 
+     * for the whole pass; remote blocks alternate between the other two. */
+    void startSymmetricStep() const
+    {
+        int num_procs = _num_procs, rank = _rank, s = _ring_step;
+        int num_steps = _ring_steps - 1;
+        int num_own = _block_sources[rank];
+        atomic_node_view atomic_zdot = _ring_zdot;
+
+        auto postStep = [&](int step, buffer_view recv_message) {
+            int from = (rank + num_procs - step) % num_procs;
+            MPI_Irecv(recv_message.data(), source_size * _block_sources[from],
+                      MPI_DOUBLE, from, 0, _comm, &_ring_requests[0]);
+            MPI_Isend(_message1.data(), source_size * num_own,
+                      MPI_DOUBLE, (rank + step) % num_procs, 0, _comm, &_ring_requests[1]);
+        };
+
+        if (s == 0) {
+            // Start sending our block for the first step and compute our own interactions
+            if (num_steps > 0) postStep(1, _cur_message);
+            _ring_start = MPI_Wtime();
+            computeSymmetricSelfPiece(atomic_zdot, _message1);
+        } else {
+            // Wait for this step's block, then start moving the next one
+            double waiting = MPI_Wtime();
+            int hidden = 0;
+            MPI_Testall(2, _ring_requests, &hidden, MPI_STATUSES_IGNORE);
+            if (!hidden) MPI_Waitall(2, _ring_requests, MPI_STATUSES_IGNORE);
+            if (s < num_steps) postStep(s + 1, _next_message);
+            _ring_timings[s].wait += MPI_Wtime() - waiting;
+            _ring_timings[s].hidden += hidden;
+
+            int from = (rank + num_procs - s) % num_procs;
+            bool reciprocal = !(num_procs % 2 == 0 && s == num_steps);
+            auto return_send = _return_send[s % 2];
+            _ring_start = MPI_Wtime();
+            if (reciprocal) Kokkos::deep_copy(_exec, return_send, 0.0);
+            computeSymmetricPiece(atomic_zdot, _message1, _cur_message,
+                                  _block_sources[from], return_send, reciprocal);
+
+            // Finish returning the last step's velocities behind this step's computation
+            waiting = MPI_Wtime();
+            finishReturn();
+            _ring_timings[s].wait += MPI_Wtime() - waiting;
+        }
+        _ring_launched = true;
+    }
+
+    /* Wait for the computation of the current symmetric ring step and start
+     * exchanging the velocities it computed for the other side of the pair.
+     * The exchange completes during the next step's computation, or right
+     * away after the last step. */
+    void finishSymmetricStep() const
+    {
+        int num_procs = _num_procs, rank = _rank, s = _ring_step;
+        int num_steps = _ring_steps - 1;
+        auto & timing = _ring_timings[s];
+
+        _exec.fence();
+        double computed = MPI_Wtime();
+        timing.compute += computed - _ring_start;
+        timing.samples++;
+
+        if (s > 0) {
+            // Return the velocities we computed for rank - s and get ours from rank + s
+            int from = (rank + num_procs - s) % num_procs;
+            int to = (rank + s) % num_procs;
+            bool reciprocal = !(num_procs % 2 == 0 && s == num_steps);
+            if (reciprocal) {
+                int b = s % 2;
+                MPI_Irecv(_return_recv[b].data(), 3 * _block_sources[rank], MPI_DOUBLE,
+                          to, 1, _comm, &_return_requests[0]);
+                MPI_Isend(_return_send[b].data(), 3 * _block_sources[from], MPI_DOUBLE,
+                          from, 1, _comm, &_return_requests[1]);
+                _return_pending = b;
+            }
+            std::swap(_cur_message, _next_message);
+        }
+
+        if (s == num_steps) {
+            finishReturn();
+            _exec.fence();
+        }
+        timing.wait += MPI_Wtime() - computed;
+
+        _ring_launched = false;
+        _ring_step++;
+    }
+
+    /* Wait for the velocities returned to us on the last symmetric ring
+     * step, if any, and add them to the interface velocity */
+    void finishReturn() const
+    {
+        if (_return_pending < 0) return;
+        atomic_node_view atomic_zdot = _ring_zdot;
+        MPI_Waitall(2, _return_requests, MPI_STATUSES_IGNORE);
+        addReturnedVelocity(atomic_zdot, _return_recv[_return_pending]);
+        _return_pending = -1;
+    }
+
+    /* Add the velocities induced on our nodes by a remote block, returned by 
+     * the owner of that block, to the interface velocity */
+    template <class AtomicView>
+    void addReturnedVelocity(AtomicView atomic_zdot, buffer_view return_message) const
+    {
+        int num_own = _block_sources[_rank];
+        source_view returned(return_message.data(), num_own, 3);
+        auto local_node_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        int imin = _local_L2G.local_own_min[0], jmin = _local_L2G.local_own_min[1];
+        int jwidth = _local_L2G.local_own_max[1] - jmin;
+
+        Kokkos::parallel_for("Exact BR Returned Velocity",
+            Cabana::Grid::createExecutionPolicy(local_node_space, _exec),
+            KOKKOS_LAMBDA(int i, int j) {
+            int s = (i - imin) * jwidth + (j - jmin);
+            for (int d = 0; d < 3; d++) {
+                atomic_zdot(i, j, d) += returned(s, d);
+            }
+        });
+    }
+
     /* Directly compute the interface velocity by integrating the vorticity 
      * across the surface. 
      * This function is called three times per time step to compute the initial, forward, and half-step
      * derivatives for velocity and vorticity.
      */
-    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        computeInterfaceVelocityBegin(zdot, z, w);
+        computeInterfaceVelocityFinish();
+    }
+
+    /* Start computing the interface velocity: pack our sources, post the
+     * first ring-pass transfer and launch the computation on our own block 
+     * on the solver's execution space instance, and return without waiting 
+     * for either so the caller can overlap other work with them. */
+    void computeInterfaceVelocityBegin(node_view zdot, node_view z, node_view w) const override
     {
         auto local_node_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
 
-        int num_procs = -1;
-        int rank = -1;
-        MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
-        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        // z and w were produced on the default instance, so make sure they're done
+        ExecutionSpace().fence();
 
         /* Start by zeroing the interface velocity */
         
@@ -206,111 +826,183 @@ class ExactBRSolver
     
         /* Zero out all of the i/j points - XXX Is this needed are is this already zeroed somewhere else? */
         Kokkos::parallel_for("Exact BR Zero Loop",
-            Cabana::Grid::createExecutionPolicy(local_node_space, ExecutionSpace()),
+            Cabana::Grid::createExecutionPolicy(local_node_space, _exec),
             KOKKOS_LAMBDA(int i, int j) {
             for (int n = 0; n < 3; n++)
                 atomic_zdot(i, j, n) = 0.0;
         });
-        
-        // Compute forces for all owned nodes on this process
-        computeInterfaceVelocityPiece(atomic_zdot, z, z, w, _local_L2G);
-
-        /* Perform a ring pass of data between each process to compute forces of nodes 
-         * on other processes on he nodes owned by this process */
-        int next_rank = (rank + 1) % num_procs;
-        int prev_rank = (rank + num_procs - 1) % num_procs;
-
-        // Create views for receiving data. Alternate which views are being sent and received into
-        // *remote2 sends first, so it needs to be deep copied. *remote1 can just be allocated
-        node_view wremote1(Kokkos::ViewAllocateWithoutInitializing ("wremote1"), w.extent(0), w.extent(1), w.extent(2));
-        node_view wremote2(Kokkos::ViewAllocateWithoutInitializing ("wremote2"), w.extent(0), w.extent(1), w.extent(2));
-        node_view zremote1(Kokkos::ViewAllocateWithoutInitializing ("zremote1"), z.extent(0), z.extent(1), z.extent(2));
-        node_view zremote2(Kokkos::ViewAllocateWithoutInitializing ("zremote2"), z.extent(0), z.extent(1), z.extent(2));
-        l2g_type L2G_remote1 = Cabana::Grid::IndexConversion::createL2G(*_pm.mesh().localGrid(), Cabana::Grid::Node());
-        l2g_type L2G_remote2 = Cabana::Grid::IndexConversion::createL2G(*_pm.mesh().localGrid(), Cabana::Grid::Node());
-        
-        int wextents1[3];
-        int wextents2[3];
-        int zextents1[3];
-        int zextents2[3];
-  
-        // Now create references to these buffers. We go ahead and assign them here to get 
-        // same type declarations. The loop reassigns these references as needed each time
-        // around the loop.
-        node_view *zsend_view = NULL; 
-        node_view *wsend_view = NULL; 
-        int * zsend_extents = NULL;
-        int * wsend_extents = NULL;
-        l2g_type * L2G_send = NULL;
-
-        node_view *zrecv_view = NULL; 
-        node_view *wrecv_view = NULL; 
-        int * zrecv_extents = NULL;
-        int * wrecv_extents = NULL;
-        l2g_type * L2G_recv = NULL;
-
-        // Perform the ring pass
-        //int DEBUG_RANK = 1;
-        for (int i = 0; i < num_procs - 1; i++) {
-
-            // Alternate between remote1 and remote2 sending and receiving data 
-            // to avoid copying data across interations
-            if (i % 2) {
-                zsend_view = &zremote1; wsend_view = &wremote1; 
-                zsend_extents = zextents1; wsend_extents = wextents1;
-                L2G_send = &L2G_remote1;
-
-                zrecv_view = &zremote2; wrecv_view = &wremote2; 
-                zrecv_extents = zextents2; wrecv_extents = wextents2;
-                L2G_recv = &L2G_remote2;
-            } else {
-                if (i == 0) {
-                    /* Avoid a deep copy on the first iteration */
-                    wsend_view = &w; zsend_view = &z;
-                } else {
-                    wsend_view = &wremote2; zsend_view = &zremote2; 
-                } 
-                
-                zsend_extents = zextents2; wsend_extents = wextents2;
-                L2G_send = &L2G_remote2;
-
-                zrecv_view = &zremote1; wrecv_view = &wremote1; 
-                zrecv_extents = zextents1; wrecv_extents = wextents1;
-                L2G_recv = &L2G_remote1;
-            }
 
-            // Prepare extents to send
-            for (int j = 0; j < 3; j++) {
-                wsend_extents[j] = wsend_view->extent(j);
-                zsend_extents[j] = zsend_view->extent(j);
-            }
-                
-            // Send w and z view sizes
-            MPI_Sendrecv(wsend_extents, 3, MPI_INT, next_rank, 0, 
-                        wrecv_extents, 3, MPI_INT, prev_rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Sendrecv(zsend_extents, 3, MPI_INT, next_rank, 1, 
-                        zrecv_extents, 3, MPI_INT, prev_rank, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            // Resize *remote2, which is receiving data
-            Kokkos::resize(*wrecv_view, wrecv_extents[0], wrecv_extents[1], wrecv_extents[2]);
-            Kokkos::resize(*zrecv_view, zrecv_extents[0], zrecv_extents[1], zrecv_extents[2]);
-            
-            // Send/receive the views
-            MPI_Sendrecv(wsend_view->data(), int(wsend_view->size()), MPI_DOUBLE, next_rank, 2, 
-                        wrecv_view->data(), int(wrecv_view->size()), MPI_DOUBLE, prev_rank, 2, 
-                        MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Sendrecv(zsend_view->data(), int(zsend_view->size()), MPI_DOUBLE, next_rank, 3, 
-                        zrecv_view->data(), int(zrecv_view->size()), MPI_DOUBLE, prev_rank, 3, 
-                        MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            // Send/receive the L2G structs. They have a constant size of 72 bytes (found using sizeof())
-            MPI_Sendrecv(L2G_send, int(sizeof(*L2G_send)), MPI_BYTE, next_rank, 4, 
-                         L2G_recv, int(sizeof(*L2G_recv)), MPI_BYTE, prev_rank, 4, 
-                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            // Do computations
-            computeInterfaceVelocityPiece(atomic_zdot, z, *zrecv_view, *wrecv_view, *L2G_recv);
-	    }
+        // Alternate which message buffer is being computed on and received into 
+        // to avoid copying data across iterations. The symmetric pass keeps
+        // our own block in the first buffer and alternates the other two.
+        _ring_zdot = zdot;
+        _ring_z = z;
+        _cur_message = _symmetric ? _message2 : _message1;
+        _next_message = _symmetric ? _message3 : _message2;
+
+        // Pack our own sources, which is the first block we compute on and send
+        computeSourceStrengths(_symmetric ? _message1 : _cur_message, z, w);
+
+        // The message we send was filled in by a kernel, so make sure it's done
+        _exec.fence();
+        _ring_step = 0;
+        _ring_steps = _symmetric ? _num_procs / 2 + 1 : _num_procs;
+        _return_pending = -1;
+        startStep();
+    }
+
+    /* Finish the step of the ring pass in progress and start the next one,
+     * without waiting for anything else. Callers that do other work between
+     * Begin and Finish call this between phases of that work so that the 
+     * ring keeps moving while they do. */
+    void computeInterfaceVelocityProgress() const override
+    {
+        if (_ring_step >= _ring_steps) return;
+        if (!_ring_launched) startStep();
+        finishStep();
+        if (_ring_step < _ring_steps) startStep();
+    }
+
+    /* Finish the ring pass started by computeInterfaceVelocityBegin. The 
+     * interface velocity is complete when this returns. */
+    void computeInterfaceVelocityFinish() const override
+    {
+        while (_ring_step < _ring_steps) {
+            if (!_ring_launched) startStep();
+            finishStep();
+        }
+    }
+
+    void startStep() const
+    {
+        if (_symmetric) startSymmetricStep();
+        else startRingStep();
+    }
+
+    void finishStep() const
+    {
+        if (_symmetric) finishSymmetricStep();
+        else finishRingStep();
+    }
+
+    /* Perform a ring pass of data between each process to compute forces of nodes 
+     * on other processes on he nodes owned by this process. Each step sends
+     * a single packed message of owned sources; received messages are 
+     * forwarded unchanged on the next step. The send of the block in hand
+     * and the receive of the next block are overlapped with the 
+     * computation on the block in hand, starting with our own block. 
+     * Step i computes on the block owned by rank - i and receives the block 
+     * owned by rank - i - 1, whose sizes we already know. */
+    void startRingStep() const
+    {
+        int num_procs = _num_procs, rank = _rank, i = _ring_step;
+        int cur_sources = _block_sources[(rank + num_procs - i) % num_procs];
+        int next_sources = _block_sources[(rank + 2 * num_procs - i - 1) % num_procs];
+
+        // Start moving the next block around the ring 
+        if (i < num_procs - 1) {
+            MPI_Irecv(_next_message.data(), source_size * next_sources, 
+                      MPI_DOUBLE, (rank + num_procs - 1) % num_procs, 0, _comm, &_ring_requests[0]);
+            MPI_Isend(_cur_message.data(), source_size * cur_sources, 
+                      MPI_DOUBLE, (rank + 1) % num_procs, 0, _comm, &_ring_requests[1]);
+        }
+
+        // Compute on the block we have while that's in flight
+        _ring_start = MPI_Wtime();
+        computeInterfaceVelocityPiece(_ring_zdot, _ring_z, _cur_message, cur_sources);
+        _ring_launched = true;
+    }
+
+    /* Wait for the computation and communication of the current ring step */
+    void finishRingStep() const
+    {
+        int i = _ring_step, hidden = 0;
+        bool last = (i == _num_procs - 1);
+
+        Kokkos::Profiling::pushRegion("Exact BR Ring Compute");
+        _exec.fence();
+        Kokkos::Profiling::popRegion();
+        double computed = MPI_Wtime();
+
+        // Wait for whatever communication wasn't hidden by the computation
+        Kokkos::Profiling::pushRegion("Exact BR Ring Wait");
+        if (!last) {
+            MPI_Testall(2, _ring_requests, &hidden, MPI_STATUSES_IGNORE);
+            if (!hidden) MPI_Waitall(2, _ring_requests, MPI_STATUSES_IGNORE);
+        }
+        Kokkos::Profiling::popRegion();
+        double waited = MPI_Wtime();
+
+        auto & timing = _ring_timings[i];
+        timing.compute += computed - _ring_start;
+        timing.wait += waited - computed;
+        timing.hidden += hidden;
+        timing.samples++;
+
+        std::swap(_cur_message, _next_message);
+        _ring_launched = false;
+        _ring_step++;
+    }
+
+    /* Accumulated timings of each step of the ring pass since construction
+     * or the last reset. Step 0 computes on our own block; every step except
+     * the last also sends the block being computed on and receives the next.
+     * Wait time is the communication not hidden behind computation, and 
+     * hidden counts the calls in which the transfer finished before the 
+     * computation did. */
+    struct RingStepTiming
+    {
+        double compute = 0.0;
+        double wait = 0.0;
+        int hidden = 0;
+        int samples = 0;
+    };
+
+    const std::vector<RingStepTiming> & ringTimings() const
+    {
+        return _ring_timings;
+    }
+
+    void resetRingTimings()
+    {
+        _ring_timings.assign(_num_procs, RingStepTiming());
+    }
+
+    /* Performance report printed by the solver at the end of a run */
+    void printTimings(std::ostream & out) const override
+    {
+        printRingTimings(out);
+    }
+
+    /* Print the per-step ring timings, taking the maximum compute and wait 
+     * time of each step across processes */
+    void printRingTimings(std::ostream & out) const
+    {
+        int rank = _rank, num_steps = _ring_timings.size();
+        if (_ring_timings[0].samples == 0) return;
+
+        std::vector<double> local(2 * num_steps), global(2 * num_steps);
+        std::vector<int> local_hidden(num_steps), global_hidden(num_steps);
+        for (int i = 0; i < num_steps; i++) {
+            local[2*i] = _ring_timings[i].compute;
+            local[2*i + 1] = _ring_timings[i].wait;
+            local_hidden[i] = _ring_timings[i].hidden;
+        }
+        MPI_Reduce(local.data(), global.data(), 2 * num_steps, MPI_DOUBLE, MPI_MAX, 0, _comm);
+        MPI_Reduce(local_hidden.data(), global_hidden.data(), num_steps, MPI_INT, MPI_MIN, 0, _comm);
+        if (rank != 0) return;
+
+        double compute = 0.0, wait = 0.0;
+        out << "===== Exact BR Ring Pass Timings (max over ranks) =====\n";
+        for (int i = 0; i < num_steps; i++) {
+            out << "Step " << i << ": compute " << global[2*i] << " s, wait " 
+                << global[2*i + 1] << " s, hidden " << global_hidden[i] << " / "
+                << _ring_timings[i].samples << "\n";
+            compute += global[2*i];
+            wait += global[2*i + 1];
+        }
+        out << "Total: compute " << compute << " s, exposed communication " << wait << " s\n"
+            << "=======================================================\n";
     }
     
     template <class l2g_type, class View>
@@ -357,11 +1049,35 @@ class ExactBRSolver
 
   private:
     const pm_type & _pm;
-    const BoundaryCondition & _bc;
-    double _epsilon, _dx, _dy;
+    double _epsilon;
+    bool _symmetric;
+    BRKernel _kernel;
+
+    // The ring pass runs on its own execution space instance so that it can
+    // overlap work the caller runs on the default instance
+    ExecutionSpace _exec;
     MPI_Comm _comm;
+    int _num_procs, _rank;
     l2g_type _local_L2G;
-    // XXX Communication views and extents to avoid allocations during each ring pass
+    BRSources<ExecutionSpace, MemorySpace> _sources;
+
+    // Communication buffers and block sizes, set up once at construction
+    // to avoid allocations and metadata exchanges during each ring pass
+    std::vector<int> _block_sources;
+    buffer_view _message1, _message2, _message3;
+    buffer_view _return_send[2], _return_recv[2];
+    mutable std::vector<RingStepTiming> _ring_timings;
+
+    // State of a ring pass between computeInterfaceVelocityBegin and Finish
+    mutable node_view _ring_zdot, _ring_z;
+    mutable buffer_view _cur_message, _next_message;
+    mutable MPI_Request _ring_requests[2];
+    mutable MPI_Request _return_requests[2];
+    mutable int _return_pending = -1;
+    mutable int _ring_step = 0;
+    mutable int _ring_steps = 0;
+    mutable bool _ring_launched = false;
+    mutable double _ring_start = 0.0;
 };
 
 }; // namespace Beatnik
@@ -0,0 +1,792 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file FMMBRSolver.hpp
+ *
+ * @section DESCRIPTION
+ * Class that approximates the Birkhoff-Rott velocity integral with a fast
+ * multipole method. The BR velocity is the curl of the vector potential
+ *   psi(x) = sum_j omega_j / |x - y_j|,
+ * so the solver runs a Cartesian Taylor-series FMM for the three Laplace
+ * potentials whose charges are the components of the weighted vorticity and
+ * takes the curl of their gradients at each target. Near-field leaf pairs
+ * are summed directly with the desingularized BR kernel.
+ *
+ * The FMM runs over the distributed octree of BRSourceTree. Each process
+ * forms the multipole expansions of a tree over its own points and sends
+ * the well-separated ones to the processes that need them in place of their
+ * sources. The locally essential tree each process builds from what it
+ * receives gets its own upward pass, with the remote cells shifted in like
+ * children. Local expansions are only formed and evaluated for cells that
+ * contain points this process owns, and a remote cell in a near-field leaf
+ * is evaluated directly at the target from its multipole expansion. The
+ * expansion order is a runtime parameter, and the solver can optionally
+ * compare its result against the exact solver, which is only practical on
+ * small problems.
+ */
+
+#ifndef BEATNIK_FMMBRSOLVER_HPP
+#define BEATNIK_FMMBRSOLVER_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_Sort.hpp>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <BRSolverBase.hpp>
+#include <BRSourceTree.hpp>
+#include <ExactBRSolver.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+#include <SolverParams.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The FMMBRSolver Class
+ * @class FMMBRSolver
+ * @brief Approximates the Birkhoff-Rott integral with a Cartesian fast
+ * multipole method of runtime-selectable order
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class FMMBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
+{
+  public:
+    using exec_space = ExecutionSpace;
+    using memory_space = MemorySpace;
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+
+    using node_view = Kokkos::View<double***, device_type>;
+    using tree_type = BRSourceTree<ExecutionSpace, MemorySpace>;
+    using exact_type = ExactBRSolver<ExecutionSpace, MemorySpace>;
+    using expansion_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type>;
+    using table_view = Kokkos::View<int**, Kokkos::LayoutLeft, device_type>;
+    using coeff_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type>;
+    using index_view = Kokkos::View<int*, device_type>;
+    using pair_view = Kokkos::View<int*[2], device_type>;
+
+    /* Highest expansion order supported, which bounds the per-thread
+     * storage the expansion kernels need. The M2L and M2P kernels keep the
+     * derivatives up to twice the order on the stack, max_derivs doubles
+     * per thread: 455 (3.6KB) at order 6. That spills to local memory on
+     * GPUs, so the compiled-in limit is a trade between the orders the
+     * solver offers and the occupancy of those kernels at any order. */
+    static constexpr int max_order = 6;
+
+    /* Number of multi-indices k with |k| <= p */
+    static constexpr int numCoeffs(int p)
+    {
+        return (p + 1) * (p + 2) * (p + 3) / 6;
+    }
+
+    static constexpr int max_coeffs = (max_order + 1) * (max_order + 2) * (max_order + 3) / 6;
+    static constexpr int max_derivs = (2 * max_order + 1) * (2 * max_order + 2) * (2 * max_order + 3) / 6;
+
+    FMMBRSolver( const pm_type & pm, const BoundaryCondition &bc,
+                 const double epsilon, const double dx, const double dy,
+                 const SolverParams & params = SolverParams() )
+        : _pm( pm )
+        , _epsilon( epsilon )
+        , _theta( params.br_theta )
+        , _order( params.br_fmm_order )
+        , _tree( pm, bc, dx, dy, params.br_leaf_size )
+    {
+        _comm = _pm.mesh().localGrid()->globalGrid().comm();
+        MPI_Comm_rank(_comm, &_rank);
+
+        if (_theta <= 0.0 || params.br_leaf_size < 1) {
+            throw std::invalid_argument("Invalid FMM opening angle or leaf size");
+        }
+        if (_order < 1 || _order > max_order) {
+            throw std::invalid_argument("FMM expansion order must be between 1 and "
+                                        + std::to_string(max_order));
+        }
+
+        buildTables();
+
+        if (params.br_fmm_check) {
+            _exact = std::make_unique<exact_type>(pm, bc, epsilon, dx, dy, params);
+        }
+    }
+
+    /* Build the multi-index tables the expansion kernels use. Multi-indices
+     * are ordered by total degree, so the first numCoeffs(p) of them are the
+     * ones of degree at most p. */
+    void buildTables()
+    {
+        int p = _order, n = numCoeffs(p), nd = numCoeffs(2 * p);
+        int dim = 2 * p + 1;
+
+        std::vector<std::array<int, 3>> mi;
+        std::vector<int> lookup(dim * dim * dim, -1);
+        for (int deg = 0; deg <= 2 * p; deg++) {
+            for (int a = deg; a >= 0; a--) {
+                for (int b = deg - a; b >= 0; b--) {
+                    lookup[(a * dim + b) * dim + (deg - a - b)] = mi.size();
+                    mi.push_back({a, b, deg - a - b});
+                }
+            }
+        }
+        auto index = [&](int a, int b, int c) {
+            if (a < 0 || b < 0 || c < 0) return -1;
+            return lookup[(a * dim + b) * dim + c];
+        };
+        auto binomial = [](int m, int k) {
+            double r = 1.0;
+            for (int i = 1; i <= k; i++) r = r * (m - k + i) / i;
+            return r;
+        };
+
+        _exponents = table_view("FMM exponents", nd, 3);
+        _prev = table_view("FMM previous indices", nd, 6);
+        _pair_index = table_view("FMM M2L indices", n, n);
+        _pair_coeff = coeff_view("FMM M2L coefficients", n, n);
+        _shift_index = table_view("FMM shift indices", n, n);
+        _shift_coeff = coeff_view("FMM shift coefficients", n, n);
+        auto exponents = Kokkos::create_mirror_view(_exponents);
+        auto prev = Kokkos::create_mirror_view(_prev);
+        auto pair_index = Kokkos::create_mirror_view(_pair_index);
+        auto pair_coeff = Kokkos::create_mirror_view(_pair_coeff);
+        auto shift_index = Kokkos::create_mirror_view(_shift_index);
+        auto shift_coeff = Kokkos::create_mirror_view(_shift_coeff);
+
+        for (int k = 0; k < nd; k++) {
+            auto e = mi[k];
+            for (int d = 0; d < 3; d++) {
+                auto e1 = e, e2 = e;
+                e1[d] -= 1;
+                e2[d] -= 2;
+                exponents(k, d) = e[d];
+                prev(k, d) = index(e1[0], e1[1], e1[2]);
+                prev(k, d + 3) = index(e2[0], e2[1], e2[2]);
+            }
+        }
+
+        for (int k = 0; k < n; k++) {
+            for (int l = 0; l < n; l++) {
+                auto a = mi[k], b = mi[l];
+
+                /* M2L: multipole coefficient k contributes to local
+                 * coefficient l through derivative k + l */
+                pair_index(k, l) = index(a[0] + b[0], a[1] + b[1], a[2] + b[2]);
+                pair_coeff(k, l) = ((b[0] + b[1] + b[2]) % 2 ? -1.0 : 1.0)
+                    * binomial(a[0] + b[0], a[0]) * binomial(a[1] + b[1], a[1])
+                    * binomial(a[2] + b[2], a[2]);
+
+                /* M2M and L2L: coefficient l shifted into coefficient k
+                 * through the monomial of the shift of degree k - l */
+                shift_index(k, l) = index(a[0] - b[0], a[1] - b[1], a[2] - b[2]);
+                shift_coeff(k, l) = (shift_index(k, l) < 0) ? 0.0
+                    : binomial(a[0], b[0]) * binomial(a[1], b[1]) * binomial(a[2], b[2]);
+            }
+        }
+
+        Kokkos::deep_copy(_exponents, exponents);
+        Kokkos::deep_copy(_prev, prev);
+        Kokkos::deep_copy(_pair_index, pair_index);
+        Kokkos::deep_copy(_pair_coeff, pair_coeff);
+        Kokkos::deep_copy(_shift_index, shift_index);
+        Kokkos::deep_copy(_shift_coeff, shift_coeff);
+    }
+
+    /* Monomials d^k of a vector for the first n multi-indices */
+    template <class TableView>
+    static KOKKOS_INLINE_FUNCTION
+    void monomials(double out[], const double d[3], int n, TableView exponents, TableView prev)
+    {
+        out[0] = 1.0;
+        for (int k = 1; k < n; k++) {
+            int i = (exponents(k, 0) > 0) ? 0 : ((exponents(k, 1) > 0) ? 1 : 2);
+            out[k] = out[prev(k, i)] * d[i];
+        }
+    }
+
+    /* Taylor coefficients a_k = D_y^k (1 / |x - y|) / k! at r = x - y for
+     * the first n multi-indices, using the recurrence
+     *   |k| |r|^2 a_k = (2|k| - 1) sum_i r_i a_{k - e_i}
+     *                   - (|k| - 1) sum_i a_{k - 2e_i} */
+    template <class TableView>
+    static KOKKOS_INLINE_FUNCTION
+    void derivatives(double out[], const double r[3], int n, TableView exponents, TableView prev)
+    {
+        double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+        out[0] = 1.0 / sqrt(r2);
+        for (int k = 1; k < n; k++) {
+            int deg = exponents(k, 0) + exponents(k, 1) + exponents(k, 2);
+            double first = 0.0, second = 0.0;
+            for (int i = 0; i < 3; i++) {
+                if (prev(k, i) >= 0) first += r[i] * out[prev(k, i)];
+                if (prev(k, i + 3) >= 0) second += out[prev(k, i + 3)];
+            }
+            out[k] = ((2 * deg - 1) * first - (deg - 1) * second) / (deg * r2);
+        }
+    }
+
+    /* What the dual tree traversal does with a pair of cells */
+    enum { PAIR_M2L = 0, PAIR_P2P = 1, PAIR_SPLIT_TARGET = 2, PAIR_SPLIT_SOURCE = 3 };
+
+    /* Work out the FMM interaction lists for the current essential tree,
+     * which already holds the periodic images we need, with a dual tree
+     * traversal. Cell pairs whose bounding spheres are well separated
+     * interact through their expansions, and leaf pairs which aren't are
+     * summed directly. Only target cells that hold points we own are
+     * opened. The traversal runs on the device one generation of cell
+     * pairs at a time, with every pair of a generation either accepted or
+     * replaced by the pairs of the larger cell's children. */
+    void buildInteractionLists() const
+    {
+        auto & tree = _tree.essential();
+        auto links = tree.links;
+        auto geometry = tree.geometry;
+        auto own_index = _tree.ownIndex();
+        int num_cells = tree.numCells();
+        int num_sources = tree.numSources();
+        int num_own = own_index.extent(0);
+
+        /* Mark the cells holding points we own, the parent of each cell
+         * and the leaf holding each source. own_count(s) is the number of
+         * our points before tree position s. */
+        index_view own_count("FMM own count", num_sources + 1);
+        Kokkos::parallel_for("FMM BR Mark Own",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_own),
+            KOKKOS_LAMBDA(const int s) {
+            own_count(own_index(s) + 1) = 1;
+        });
+        Kokkos::parallel_scan("FMM BR Own Count",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_sources + 1),
+            KOKKOS_LAMBDA(const int s, int & sum, const bool final) {
+            sum += own_count(s);
+            if (final) own_count(s) = sum;
+        });
+
+        _parent = index_view(Kokkos::ViewAllocateWithoutInitializing("FMM parents"), num_cells);
+        _active = index_view(Kokkos::ViewAllocateWithoutInitializing("FMM active"), num_cells);
+        _leaf_of = index_view(Kokkos::ViewAllocateWithoutInitializing("FMM leaf of"), num_sources);
+        auto parent = _parent;
+        auto active = _active;
+        auto leaf_of = _leaf_of;
+        Kokkos::parallel_for("FMM BR Cell Links",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells),
+            KOKKOS_LAMBDA(const int c) {
+            int begin = links(c, tree_type::LINK_BEGIN), end = links(c, tree_type::LINK_END);
+            active(c) = own_count(end) > own_count(begin);
+            if (c == 0) parent(c) = -1;
+            for (int k = 0; k < links(c, tree_type::LINK_NCHILD); k++) {
+                parent(links(c, tree_type::LINK_CHILD) + k) = c;
+            }
+            if (links(c, tree_type::LINK_NCHILD) == 0) {
+                for (int s = begin; s < end; s++) leaf_of(s) = c;
+            }
+        });
+
+        int root_active = 0;
+        if (num_cells > 0) Kokkos::deep_copy(root_active, Kokkos::subview(_active, 0));
+
+        double theta2 = _theta * _theta;
+        pair_view frontier("FMM BR pairs", root_active ? 1 : 0);
+        pair_view m2l("FMM M2L pairs", 0), p2p("FMM P2P pairs", 0);
+        int num_pairs = frontier.extent(0);
+        while (num_pairs > 0) {
+            index_view action(Kokkos::ViewAllocateWithoutInitializing("FMM pair action"), num_pairs);
+            index_view offset(Kokkos::ViewAllocateWithoutInitializing("FMM pair offset"), num_pairs);
+            Kokkos::parallel_for("FMM BR Classify Pairs",
+                Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+                KOKKOS_LAMBDA(const int p) {
+                int t = frontier(p, 0), s = frontier(p, 1);
+                double dist2 = 0.0;
+                for (int d = 0; d < 3; d++) {
+                    double r = geometry(t, d) - geometry(s, d);
+                    dist2 += r * r;
+                }
+                double rsum = geometry(t, 3) + geometry(s, 3);
+                bool tleaf = (links(t, tree_type::LINK_NCHILD) == 0);
+                bool sleaf = (links(s, tree_type::LINK_NCHILD) == 0);
+
+                int children = 0;
+                if (rsum * rsum < theta2 * dist2) {
+                    action(p) = PAIR_M2L;
+                } else if (tleaf && sleaf) {
+                    action(p) = PAIR_P2P;
+                } else if (sleaf || (!tleaf && geometry(t, 3) >= geometry(s, 3))) {
+                    action(p) = PAIR_SPLIT_TARGET;
+                    for (int k = 0; k < links(t, tree_type::LINK_NCHILD); k++) {
+                        children += active(links(t, tree_type::LINK_CHILD) + k);
+                    }
+                } else {
+                    action(p) = PAIR_SPLIT_SOURCE;
+                    children = links(s, tree_type::LINK_NCHILD);
+                }
+                offset(p) = children;
+            });
+
+            appendPairs(frontier, action, PAIR_M2L, m2l);
+            appendPairs(frontier, action, PAIR_P2P, p2p);
+
+            int num_next = 0;
+            Kokkos::parallel_scan("FMM BR Pair Children",
+                Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+                KOKKOS_LAMBDA(const int p, int & sum, const bool final) {
+                int children = offset(p);
+                if (final) offset(p) = sum;
+                sum += children;
+            }, num_next);
+
+            pair_view next(Kokkos::ViewAllocateWithoutInitializing("FMM BR pairs"), num_next);
+            Kokkos::parallel_for("FMM BR Split Pairs",
+                Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+                KOKKOS_LAMBDA(const int p) {
+                int t = frontier(p, 0), s = frontier(p, 1), e = offset(p);
+                if (action(p) == PAIR_SPLIT_TARGET) {
+                    for (int k = 0; k < links(t, tree_type::LINK_NCHILD); k++) {
+                        int child = links(t, tree_type::LINK_CHILD) + k;
+                        if (!active(child)) continue;
+                        next(e, 0) = child;
+                        next(e++, 1) = s;
+                    }
+                } else if (action(p) == PAIR_SPLIT_SOURCE) {
+                    for (int k = 0; k < links(s, tree_type::LINK_NCHILD); k++) {
+                        next(e, 0) = t;
+                        next(e++, 1) = links(s, tree_type::LINK_CHILD) + k;
+                    }
+                }
+            });
+            frontier = next;
+            num_pairs = num_next;
+        }
+
+        compressPairs(m2l, num_cells, _m2l_offsets, _m2l_entries);
+        compressPairs(p2p, num_cells, _p2p_offsets, _p2p_entries);
+
+        _locals = expansion_view("FMM locals", num_cells, 3 * numCoeffs(_order));
+    }
+
+    /* Append the pairs of a traversal generation with the given action to
+     * a list of pairs */
+    static void appendPairs(pair_view pairs, index_view action, int code, pair_view & list)
+    {
+        int num_pairs = pairs.extent(0), base = list.extent(0), count = 0;
+        index_view offset(Kokkos::ViewAllocateWithoutInitializing("FMM pair offset"), num_pairs);
+        Kokkos::parallel_scan("FMM BR Pair Offsets",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+            KOKKOS_LAMBDA(const int p, int & sum, const bool final) {
+            if (final) offset(p) = sum;
+            if (action(p) == code) sum++;
+        }, count);
+        if (count == 0) return;
+
+        Kokkos::resize(list, base + count);
+        auto out = list;
+        Kokkos::parallel_for("FMM BR Append Pairs",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+            KOKKOS_LAMBDA(const int p) {
+            if (action(p) != code) return;
+            out(base + offset(p), 0) = pairs(p, 0);
+            out(base + offset(p), 1) = pairs(p, 1);
+        });
+    }
+
+    /* Sort a list of (target, source) cell pairs into compressed rows of
+     * sources by target. Sorting keeps the order each target sums its
+     * sources in, and so its result, the same from run to run. */
+    static void compressPairs(pair_view pairs, int num_cells,
+                              index_view & offsets, index_view & entries)
+    {
+        int num_pairs = pairs.extent(0);
+        Kokkos::View<long*, device_type> keys(Kokkos::ViewAllocateWithoutInitializing("FMM pair keys"),
+                                             num_pairs);
+        Kokkos::parallel_for("FMM BR Pair Keys",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+            KOKKOS_LAMBDA(const int p) {
+            keys(p) = long(pairs(p, 0)) * num_cells + pairs(p, 1);
+        });
+        Kokkos::sort(ExecutionSpace(), keys);
+
+        offsets = index_view("FMM list offsets", num_cells + 1);
+        entries = index_view(Kokkos::ViewAllocateWithoutInitializing("FMM list entries"), num_pairs);
+        auto row = offsets;
+        auto entry = entries;
+        Kokkos::parallel_for("FMM BR List Entries",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_pairs),
+            KOKKOS_LAMBDA(const int p) {
+            entry(p) = keys(p) % num_cells;
+            Kokkos::atomic_increment(&row(keys(p) / num_cells + 1));
+        });
+        Kokkos::parallel_scan("FMM BR List Offsets",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells + 1),
+            KOKKOS_LAMBDA(const int c, int & sum, const bool final) {
+            sum += row(c);
+            if (final) row(c) = sum;
+        });
+    }
+
+    /* Form the multipole expansion of every leaf of a tree from its sources
+     * and by shifting in the expansions of its remote cells, and pass them
+     * up the tree level by level */
+    void upwardPass(const typename tree_type::Octree & tree, expansion_view & out) const
+    {
+        int n = numCoeffs(_order);
+        int num_cells = tree.numCells();
+        out = expansion_view("FMM multipoles", num_cells, 3 * n);
+
+        auto links = tree.links;
+        auto geometry = tree.geometry;
+        auto sources = tree.sources;
+        auto remote = tree.remote;
+        auto multipoles = out;
+        auto exponents = _exponents;
+        auto prev = _prev;
+        auto shift_index = _shift_index;
+        auto shift_coeff = _shift_coeff;
+        auto & level_begin = tree.level_begin;
+        constexpr int h = tree_type::remote_header;
+
+        Kokkos::parallel_for("FMM BR P2M",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells),
+            KOKKOS_LAMBDA(const int c) {
+            if (links(c, tree_type::LINK_NCHILD) != 0) return;
+            for (int s = links(c, tree_type::LINK_BEGIN); s < links(c, tree_type::LINK_END); s++) {
+                double delta[3], mono[max_coeffs];
+                for (int d = 0; d < 3; d++) delta[d] = sources(s, d) - geometry(c, d);
+                monomials(mono, delta, n, exponents, prev);
+                for (int a = 0; a < 3; a++) {
+                    double q = sources(s, a + 3);
+                    for (int k = 0; k < n; k++) {
+                        multipoles(c, a * n + k) += q * mono[k];
+                    }
+                }
+            }
+            for (int q = links(c, tree_type::LINK_REMOTE_BEGIN); q < links(c, tree_type::LINK_REMOTE_END); q++) {
+                double delta[3], mono[max_coeffs];
+                for (int d = 0; d < 3; d++) delta[d] = remote(q, d) - geometry(c, d);
+                monomials(mono, delta, n, exponents, prev);
+                for (int a = 0; a < 3; a++) {
+                    for (int k = 0; k < n; k++) {
+                        double sum = 0.0;
+                        for (int l = 0; l <= k; l++) {
+                            int idx = shift_index(k, l);
+                            if (idx >= 0) sum += shift_coeff(k, l) * mono[idx]
+                                                 * remote(q, h + a * n + l);
+                        }
+                        multipoles(c, a * n + k) += sum;
+                    }
+                }
+            }
+        });
+
+        for (int level = int(level_begin.size()) - 3; level >= 0; level--) {
+            Kokkos::parallel_for("FMM BR M2M",
+                Kokkos::RangePolicy<ExecutionSpace>(level_begin[level], level_begin[level + 1]),
+                KOKKOS_LAMBDA(const int c) {
+                for (int i = 0; i < links(c, tree_type::LINK_NCHILD); i++) {
+                    int child = links(c, tree_type::LINK_CHILD) + i;
+                    double delta[3], mono[max_coeffs];
+                    for (int d = 0; d < 3; d++) delta[d] = geometry(child, d) - geometry(c, d);
+                    monomials(mono, delta, n, exponents, prev);
+                    for (int a = 0; a < 3; a++) {
+                        for (int k = 0; k < n; k++) {
+                            double sum = 0.0;
+                            for (int l = 0; l <= k; l++) {
+                                int idx = shift_index(k, l);
+                                if (idx >= 0) sum += shift_coeff(k, l) * mono[idx]
+                                                     * multipoles(child, a * n + l);
+                            }
+                            multipoles(c, a * n + k) += sum;
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    /* Convert the well-separated multipoles of each active cell into its
+     * local expansion and pass the local expansions down the tree */
+    void downwardPass() const
+    {
+        auto & tree = _tree.essential();
+        auto geometry = tree.geometry;
+        auto multipoles = _multipoles;
+        auto locals = _locals;
+        auto exponents = _exponents;
+        auto prev = _prev;
+        auto pair_index = _pair_index;
+        auto pair_coeff = _pair_coeff;
+        auto shift_index = _shift_index;
+        auto shift_coeff = _shift_coeff;
+        auto m2l_offsets = _m2l_offsets;
+        auto m2l_entries = _m2l_entries;
+        auto parent = _parent;
+        auto active = _active;
+        int n = numCoeffs(_order), nd = numCoeffs(2 * _order);
+        int num_cells = tree.numCells();
+        auto & level_begin = tree.level_begin;
+
+        Kokkos::parallel_for("FMM BR M2L",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells),
+            KOKKOS_LAMBDA(const int t) {
+            for (int e = m2l_offsets(t); e < m2l_offsets(t + 1); e++) {
+                int s = m2l_entries(e);
+                double r[3], deriv[max_derivs];
+                for (int d = 0; d < 3; d++) r[d] = geometry(t, d) - geometry(s, d);
+                derivatives(deriv, r, nd, exponents, prev);
+                for (int a = 0; a < 3; a++) {
+                    for (int l = 0; l < n; l++) {
+                        double sum = 0.0;
+                        for (int k = 0; k < n; k++) {
+                            sum += pair_coeff(k, l) * deriv[pair_index(k, l)]
+                                   * multipoles(s, a * n + k);
+                        }
+                        locals(t, a * n + l) += sum;
+                    }
+                }
+            }
+        });
+
+        for (std::size_t level = 1; level + 1 < level_begin.size(); level++) {
+            Kokkos::parallel_for("FMM BR L2L",
+                Kokkos::RangePolicy<ExecutionSpace>(level_begin[level], level_begin[level + 1]),
+                KOKKOS_LAMBDA(const int c) {
+                if (!active(c)) return;
+                int p = parent(c);
+                double delta[3], mono[max_coeffs];
+                for (int d = 0; d < 3; d++) delta[d] = geometry(c, d) - geometry(p, d);
+                monomials(mono, delta, n, exponents, prev);
+                for (int a = 0; a < 3; a++) {
+                    for (int l = 0; l < n; l++) {
+                        double sum = 0.0;
+                        for (int k = l; k < n; k++) {
+                            int idx = shift_index(k, l);
+                            if (idx >= 0) sum += shift_coeff(k, l) * mono[idx]
+                                                 * locals(p, a * n + k);
+                        }
+                        locals(c, a * n + l) += sum;
+                    }
+                }
+            });
+        }
+    }
+
+    /* Evaluate the local expansion of each owned point's leaf and add the
+     * near-field sum over the sources and remote cells of its neighbor
+     * leaves. The velocity is the curl of the potentials. */
+    void evaluate(node_view zdot, node_view z) const
+    {
+        auto local_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto & tree = _tree.essential();
+        auto links = tree.links;
+        auto geometry = tree.geometry;
+        auto sources = tree.sources;
+        auto remote = tree.remote;
+        auto own_index = _tree.ownIndex();
+        auto leaf_of = _leaf_of;
+        auto locals = _locals;
+        auto exponents = _exponents;
+        auto prev = _prev;
+        auto pair_index = _pair_index;
+        auto pair_coeff = _pair_coeff;
+        auto p2p_offsets = _p2p_offsets;
+        auto p2p_entries = _p2p_entries;
+        int n = numCoeffs(_order), np1 = numCoeffs(_order + 1);
+        constexpr int h = tree_type::remote_header;
+        double epsilon = _epsilon;
+        int imin = local_space.min(0), jmin = local_space.min(1);
+        int jwidth = local_space.extent(1);
+
+        Kokkos::parallel_for("FMM BR L2P and P2P",
+            Cabana::Grid::createExecutionPolicy(local_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j) {
+            int c = leaf_of(own_index((i - imin) * jwidth + (j - jmin)));
+            double zi[3], delta[3], mono[max_coeffs], grad[3][3];
+            for (int d = 0; d < 3; d++) {
+                zi[d] = z(i, j, d);
+                delta[d] = zi[d] - geometry(c, d);
+            }
+
+            /* grad[a][i] is the derivative of potential a along direction i */
+            monomials(mono, delta, n, exponents, prev);
+            for (int a = 0; a < 3; a++) {
+                for (int d = 0; d < 3; d++) grad[a][d] = 0.0;
+                for (int k = 1; k < n; k++) {
+                    for (int d = 0; d < 3; d++) {
+                        if (exponents(k, d) > 0) {
+                            grad[a][d] += locals(c, a * n + k) * exponents(k, d) * mono[prev(k, d)];
+                        }
+                    }
+                }
+            }
+
+            double brsum[3] = {0.0, 0.0, 0.0}, offset[3] = {0.0, 0.0, 0.0};
+            for (int e = p2p_offsets(c); e < p2p_offsets(c + 1); e++) {
+                int s = p2p_entries(e);
+                for (int k = links(s, tree_type::LINK_BEGIN); k < links(s, tree_type::LINK_END); k++) {
+                    double zs[3], omega[3], br[3];
+                    for (int d = 0; d < 3; d++) {
+                        zs[d] = sources(k, d);
+                        omega[d] = sources(k, d + 3);
+                    }
+                    Operators::BR(br, zi, zs, omega, epsilon, offset);
+                    for (int d = 0; d < 3; d++) brsum[d] += br[d];
+                }
+
+                /* Remote cells in a near leaf were only sent as expansions
+                 * because they are well separated from all of our points, so
+                 * evaluate them directly at the point: the gradient of
+                 * sum_k M_k a_k(x - c) along i is -sum_k (k_i + 1) M_k a_{k + e_i} */
+                for (int q = links(s, tree_type::LINK_REMOTE_BEGIN); q < links(s, tree_type::LINK_REMOTE_END); q++) {
+                    double r[3], deriv[max_derivs];
+                    for (int d = 0; d < 3; d++) r[d] = zi[d] - remote(q, d);
+                    derivatives(deriv, r, np1, exponents, prev);
+                    for (int a = 0; a < 3; a++) {
+                        for (int d = 0; d < 3; d++) {
+                            double sum = 0.0;
+                            for (int k = 0; k < n; k++) {
+                                sum += pair_coeff(k, d + 1) * deriv[pair_index(k, d + 1)]
+                                       * remote(q, h + a * n + k);
+                            }
+                            grad[a][d] += sum;
+                        }
+                    }
+                }
+            }
+
+            brsum[0] += grad[2][1] - grad[1][2];
+            brsum[1] += grad[0][2] - grad[2][0];
+            brsum[2] += grad[1][0] - grad[0][1];
+
+            for (int d = 0; d < 3; d++) {
+                zdot(i, j, d) = brsum[d];
+            }
+        });
+    }
+
+    /* Compute the interface velocities with the FMM */
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        double start = MPI_Wtime();
+        Kokkos::Profiling::pushRegion("FMM BR Build");
+        _tree.update(z, w);
+        upwardPass(_tree.local(), _multipoles);
+        _tree.exchange(_multipoles, 3 * numCoeffs(_order), _theta);
+        buildInteractionLists();
+        Kokkos::Profiling::popRegion();
+        double built = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("FMM BR Evaluate");
+        upwardPass(_tree.essential(), _multipoles);
+        downwardPass();
+        evaluate(zdot, z);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double evaluated = MPI_Wtime();
+
+        _build_time += built - start;
+        _evaluate_time += evaluated - built;
+        _samples++;
+
+        if (_exact) checkAccuracy(zdot, z, w);
+    }
+
+    /* Compare the FMM velocities to the exact solver and keep track of the
+     * largest error relative to the largest exact velocity */
+    void checkAccuracy(node_view zdot, node_view z, node_view w) const
+    {
+        if (_exact_zdot.extent(0) != zdot.extent(0) || _exact_zdot.extent(1) != zdot.extent(1)) {
+            _exact_zdot = node_view("FMM exact zdot", zdot.extent(0), zdot.extent(1), 3);
+        }
+        _exact->computeInterfaceVelocity(_exact_zdot, z, w);
+
+        auto exact = _exact_zdot;
+        auto local_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        double errors[2] = {0.0, 0.0};
+        Kokkos::parallel_reduce("FMM BR Error",
+            Cabana::Grid::createExecutionPolicy(local_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j, double & max_error) {
+            for (int d = 0; d < 3; d++) {
+                max_error = Kokkos::max(max_error, Kokkos::fabs(zdot(i, j, d) - exact(i, j, d)));
+            }
+        }, Kokkos::Max<double>(errors[0]));
+        Kokkos::parallel_reduce("FMM BR Magnitude",
+            Cabana::Grid::createExecutionPolicy(local_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j, double & max_value) {
+            for (int d = 0; d < 3; d++) {
+                max_value = Kokkos::max(max_value, Kokkos::fabs(exact(i, j, d)));
+            }
+        }, Kokkos::Max<double>(errors[1]));
+        MPI_Allreduce(MPI_IN_PLACE, errors, 2, MPI_DOUBLE, MPI_MAX, _comm);
+
+        double relative = (errors[1] > 0.0) ? errors[0] / errors[1] : errors[0];
+        _max_error = std::max(_max_error, relative);
+    }
+
+    /* Print the time spent setting up and evaluating the FMM, taking the
+     * maximum across processes, and the accuracy if it was checked */
+    void printTimings(std::ostream & out) const override
+    {
+        if (_samples == 0) return;
+
+        double local[2] = {_build_time, _evaluate_time}, global[2];
+        MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_MAX, 0, _comm);
+        if (_rank != 0) return;
+
+        out << "===== FMM BR Timings (max over ranks) =====\n"
+            << "Build: " << global[0] << " s, evaluate " << global[1] << " s over "
+            << _samples << " calls (order " << _order << ", theta " << _theta << ")\n"
+            << "Local tree: " << _tree.numBuilds() << " builds, "
+            << _tree.numRefits() << " refits\n";
+        if (_exact) {
+            out << "Max error relative to exact solver: " << _max_error << "\n";
+        }
+        out << "===========================================\n";
+    }
+
+  private:
+    const pm_type & _pm;
+    double _epsilon;
+    double _theta;
+    int _order;
+    MPI_Comm _comm;
+    int _rank;
+
+    /* Multi-index tables for the expansion order */
+    table_view _exponents, _prev;
+    table_view _pair_index, _shift_index;
+    coeff_view _pair_coeff, _shift_coeff;
+
+    /* Tree, interaction lists and expansions, updated every evaluation */
+    mutable tree_type _tree;
+    mutable index_view _m2l_offsets, _p2p_offsets;
+    mutable index_view _m2l_entries, _p2p_entries;
+    mutable index_view _parent, _active, _leaf_of;
+    mutable expansion_view _multipoles, _locals;
+
+    /* Optional accuracy check against the exact solver */
+    std::unique_ptr<exact_type> _exact;
+    mutable node_view _exact_zdot;
+    mutable double _max_error = 0.0;
+
+    mutable double _build_time = 0.0, _evaluate_time = 0.0;
+    mutable int _samples = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_FMMBRSOLVER_HPP
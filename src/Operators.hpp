@@ -89,6 +89,20 @@ namespace Operators
 //        return (f(i + 1, j, d) + f(i -1, j, d) + f(i, j+1, d) + f(i, j-1,d) - 4.0 * f(i, j, d)) / (dx * dy);
     }
 
+    /* Fourier symbol of the 9-point laplace stencil above for the mode with
+     * global index (g1, g2) of an n1 x n2 periodic mesh. With t = 2 pi g / n,
+     * laplace applied to exp(i (t1 * i + t2 * j)) gives the mode times
+     * (cos t1 + cos t2 + cos t1 cos t2 - 3) / (dx dy), which is never
+     * positive. Since cos is periodic, no aliasing of g to signed
+     * wavenumbers is needed, including for the Nyquist mode of even n. */
+    KOKKOS_INLINE_FUNCTION
+    double laplaceSymbol(int g1, int n1, int g2, int n2, double dx, double dy)
+    {
+        double c1 = cos(2.0 * Kokkos::numbers::pi_v<double> * g1 / n1);
+        double c2 = cos(2.0 * Kokkos::numbers::pi_v<double> * g2 / n2);
+        return (c1 + c2 + c1 * c2 - 3.0) / (dx * dy);
+    }
+
     KOKKOS_INLINE_FUNCTION
     double dot(double u[3], double v[3]) 
     {
@@ -103,30 +117,58 @@ namespace Operators
         N[2] = u[0]*v[1] - u[1]*v[0];
     }
 
-    /* Compute the Birchorff Rott force exerted on an i/j point with given location
-     * by a k/l point with given vorticity, with an additional position offset 
-     * (to * take care of periodic boundary contitions) */
-    template <class VorticityView, class PositionView>
+    /* Simpson's 3/8 quadrature weight of an index along a dimension of 
+     * len points, used to weight each source in the Birkhoff-Rott integral */
+    KOKKOS_INLINE_FUNCTION
+    double simpsonWeight(int index, int len)
+    {
+        if (index == (len - 1) || index == 0) return 3.0/8.0;
+        else if (index % 3 == 0) return 3.0/4.0;
+        else return 9.0/8.0;
+    }
+
+    /* Compute the Birkhoff-Rott velocity induced at a point with position z
+     * by a source point with position z2 and vorticity vector omega, with an
+     * additional position offset (to take care of periodic boundary 
+     * conditions). Any quadrature weights are expected to already be folded 
+     * into omega. */
     KOKKOS_INLINE_FUNCTION
-    void BR(double out[3], PositionView z, PositionView z2, VorticityView w2,
-            double epsilon, double dx, double dy, double weight, int i, int j, int k, int l,
-            double offset[3])
+    void BR(double out[3], double z[3], double z2[3], double omega[3],
+            double epsilon, double offset[3])
     {
-        double omega[3], zdiff[3], zsize;
+        double zdiff[3], zsize;
         zsize = 0.0;
         for (int d = 0; d < 3; d++) {
-            omega[d] = w2(k, l, 1) * Dx(z2, k, l, d, dx) - w2(k, l, 0) * Dy(z2, k, l, d, dy);
-            zdiff[d] = z(i, j, d) - (z2(k, l, d) + offset[d]);
+            zdiff[d] = z[d] - (z2[d] + offset[d]);
             zsize += zdiff[d] * zdiff[d];
-        }  
+        }
         zsize = pow(zsize + epsilon, 1.5); // matlab code doesn't square epsilon
         for (int d = 0; d < 3; d++) {
             zdiff[d] /= zsize;
         }
         cross(out, omega, zdiff);
-        for (int d = 0; d < 3; d++) {  
-            out[d] *= (dx * dy * weight) / (-4.0 * Kokkos::numbers::pi_v<double>);
+    }
+
+    /* Compute the Birkhoff-Rott velocities that two points induce on each
+     * other, sharing the distance calculation between the two. out1 is the
+     * velocity induced at z1 by the source at z2 (projected by offset) and 
+     * out2 the velocity induced at that projection of z2 by the source at z1. */
+    KOKKOS_INLINE_FUNCTION
+    void BRPair(double out1[3], double out2[3], double z1[3], double z2[3], 
+                double omega1[3], double omega2[3], double epsilon, double offset[3])
+    {
+        double zdiff[3], zsize;
+        zsize = 0.0;
+        for (int d = 0; d < 3; d++) {
+            zdiff[d] = z1[d] - (z2[d] + offset[d]);
+            zsize += zdiff[d] * zdiff[d];
+        }
+        zsize = pow(zsize + epsilon, 1.5); // matlab code doesn't square epsilon
+        for (int d = 0; d < 3; d++) {
+            zdiff[d] /= zsize;
         }
+        cross(out1, omega2, zdiff);
+        cross(out2, zdiff, omega1);
     }
 
     template <long M, long N>
@@ -0,0 +1,352 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file P3MBRSolver.hpp
+ *
+ * @section DESCRIPTION
+ * Class that computes the Birkhoff-Rott velocity integral of a periodic
+ * interface with a particle-particle/particle-mesh (P3M) Ewald method. The
+ * BR velocity is the curl of the vector potential psi = sum omega / r, and
+ * 1/r is split into erfc(alpha r) / r, which is summed directly over the
+ * neighbors within a cutoff, and erf(alpha r) / r, which is smooth and is
+ * computed on a 3D spatial mesh: the vorticity is spread to the mesh, psi
+ * and its curl are computed with FFTs, and the velocity is interpolated
+ * back to the interface points. This sums over every periodic image in x
+ * and y rather than the nearest ones. The mesh is periodic in z as well,
+ * so it is padded in z to keep the images of the interface in z away, and
+ * the shear a net sheet strength gives across the padded mesh is added
+ * back to the velocity.
+ */
+
+#ifndef BEATNIK_P3MBRSOLVER_HPP
+#define BEATNIK_P3MBRSOLVER_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+#include <BRSolverBase.hpp>
+#include <BoundaryCondition.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+#include <SolverParams.hpp>
+#include <SpatialMesh.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The P3MBRSolver Class
+ * @class P3MBRSolver
+ * @brief Computes the periodic Birkhoff-Rott integral in O(N log N) time
+ * with an Ewald split between a neighbor list sum and a mesh FFT solve
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class P3MBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
+{
+  public:
+    using exec_space = ExecutionSpace;
+    using memory_space = MemorySpace;
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    using spatial_mesh_type = SpatialMesh<ExecutionSpace, MemorySpace>;
+    using particle_type = typename spatial_mesh_type::particle_type;
+    using list_type = typename spatial_mesh_type::neighbor_list_type;
+    using mesh_type = typename spatial_mesh_type::mesh_type;
+    using mesh_array_type = Cabana::Grid::Array<double, Cabana::Grid::Node, mesh_type, MemorySpace>;
+    using halo_type = Cabana::Grid::Halo<MemorySpace>;
+    using fft_type = Cabana::Grid::Experimental::HeffteFastFourierTransform<Cabana::Grid::Node,
+                         mesh_type, double, memory_space, exec_space,
+                         Cabana::Grid::Experimental::Impl::FFTBackendDefault>;
+
+    /* Ewald splitting parameter times the cutoff, which makes the part of
+     * the kernel beyond the cutoff erfc(3) = 2e-5 of the full kernel */
+    static constexpr double alpha_cutoff = 3.0;
+
+    P3MBRSolver( const pm_type & pm, const BoundaryCondition &bc,
+                 const double epsilon, const double dx, const double dy,
+                 const SolverParams & params = SolverParams() )
+        : _epsilon( epsilon )
+        , _cutoff( params.br_cutoff )
+        , _alpha( alpha_cutoff / params.br_cutoff )
+        , _spatial( pm, bc, dx, dy, params.br_mesh_spacing, 2, true )
+        , _particles( "P3M BR particles" )
+    {
+        if (!bc.isPeriodicBoundary({1, 0}) || !bc.isPeriodicBoundary({0, 1})) {
+            throw std::invalid_argument("P3M BR solver requires periodic boundaries");
+        }
+        if (_cutoff <= 0.0 || params.br_mesh_spacing <= 0.0) {
+            throw std::invalid_argument("Invalid P3M cutoff distance or mesh spacing");
+        }
+
+        /* The vorticity is spread to and the velocity interpolated from a
+         * vector field on the mesh nodes, and each component is transformed
+         * separately as a complex (real, imaginary) pair */
+        auto local_grid = _spatial.localGrid();
+        auto vector_layout = Cabana::Grid::createArrayLayout(local_grid, 3, Cabana::Grid::Node());
+        auto complex_layout = Cabana::Grid::createArrayLayout(local_grid, 2, Cabana::Grid::Node());
+        _field = Cabana::Grid::createArray<double, memory_space>("P3M field", vector_layout);
+        _field_halo = Cabana::Grid::createHalo(Cabana::Grid::NodeHaloPattern<3>(), 2, *_field);
+        for (int d = 0; d < 3; d++) {
+            _spectral[d] = Cabana::Grid::createArray<double, memory_space>("P3M spectral", complex_layout);
+        }
+
+        Cabana::Grid::Experimental::FastFourierTransformParams fft_params;
+        fft_params.setAllToAll(true);
+        fft_params.setPencils(true);
+        fft_params.setReorder(false);
+        _fft = Cabana::Grid::Experimental::createHeffteFastFourierTransform<double, memory_space>(*complex_layout, fft_params);
+    }
+
+    /* Fraction of the BR kernel at distance r summed directly, including
+     * the derivative of the erfc(alpha r) / r potential split */
+    static KOKKOS_INLINE_FUNCTION
+    double shortRangeFraction(double r, double alpha)
+    {
+        double ar = alpha * r;
+        return Kokkos::erfc(ar)
+            + 2.0 / Kokkos::sqrt(Kokkos::numbers::pi_v<double>) * ar * Kokkos::exp(-ar * ar);
+    }
+
+    /* Sum the short-range part of the kernel over the neighbors of each
+     * owned particle, storing it as the particle's velocity */
+    void computeShortRange(const int num_owned) const
+    {
+        auto list = _spatial.createNeighborList(_particles, num_owned, _cutoff);
+        auto x = Cabana::slice<spatial_mesh_type::Position>(_particles);
+        auto omega = Cabana::slice<spatial_mesh_type::Vorticity>(_particles);
+        auto u = Cabana::slice<spatial_mesh_type::Velocity>(_particles);
+        double epsilon = _epsilon, alpha = _alpha;
+
+        Kokkos::parallel_for("P3M BR Short Range",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            double zi[3], brsum[3] = {0.0, 0.0, 0.0};
+            double offset[3] = {0.0, 0.0, 0.0};
+            for (int d = 0; d < 3; d++) zi[d] = x(p, d);
+
+            int num_neighbors = Cabana::NeighborList<list_type>::numNeighbor(list, p);
+            for (int n = 0; n < num_neighbors; n++) {
+                int q = Cabana::NeighborList<list_type>::getNeighbor(list, p, n);
+                double zq[3], wq[3], br[3], r2 = 0.0;
+                for (int d = 0; d < 3; d++) {
+                    zq[d] = x(q, d);
+                    wq[d] = omega(q, d);
+                    r2 += (zi[d] - zq[d]) * (zi[d] - zq[d]);
+                }
+                Operators::BR(br, zi, zq, wq, epsilon, offset);
+                double fraction = shortRangeFraction(Kokkos::sqrt(r2), alpha);
+                for (int d = 0; d < 3; d++) brsum[d] += fraction * br[d];
+            }
+            for (int d = 0; d < 3; d++) u(p, d) = brsum[d];
+        });
+    }
+
+    /* Add the long-range part of the velocity of each owned particle,
+     * computed on the mesh */
+    void computeLongRange(const int num_owned) const
+    {
+        auto local_grid = _spatial.localGrid();
+        auto & global_grid = local_grid->globalGrid();
+        auto own_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto x = Cabana::slice<spatial_mesh_type::Position>(_particles);
+        auto omega = Cabana::slice<spatial_mesh_type::Vorticity>(_particles);
+        auto u = Cabana::slice<spatial_mesh_type::Velocity>(_particles);
+
+        /* Spread the vorticity of the owned particles to the mesh with
+         * cloud-in-cell weights; ghosts are copies and are not spread */
+        Cabana::Grid::ArrayOp::assign(*_field, 0.0, Cabana::Grid::Ghost());
+        Cabana::Grid::p2g(Cabana::Grid::createVectorValueP2G(omega, 1.0), x, num_owned,
+                          Cabana::Grid::Spline<1>(), *_field_halo, *_field);
+
+        auto field = _field->view();
+        auto s0 = _spectral[0]->view();
+        auto s1 = _spectral[1]->view();
+        auto s2 = _spectral[2]->view();
+        Kokkos::parallel_for("P3M BR Build FFT Arrays",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            s0(i, j, k, 0) = field(i, j, k, 0);
+            s1(i, j, k, 0) = field(i, j, k, 1);
+            s2(i, j, k, 0) = field(i, j, k, 2);
+            s0(i, j, k, 1) = 0.0;
+            s1(i, j, k, 1) = 0.0;
+            s2(i, j, k, 1) = 0.0;
+        });
+        for (int d = 0; d < 3; d++) {
+            _fft->forward(*_spectral[d], Cabana::Grid::Experimental::FFTScaleNone());
+        }
+
+        /* Solve -laplacian psi = 4 pi omega with the long-range Ewald
+         * Green's function, deconvolved by the cloud-in-cell window once
+         * for spreading and once for interpolation, and take u = i k x psi.
+         * The mean and Nyquist modes carry no velocity. The kx = ky = 0
+         * modes are solved as periodic in z like the rest, and what that
+         * leaves out is added once the velocity is on the particles. */
+        Kokkos::Array<int, 3> offset, num_node;
+        Kokkos::Array<double, 3> kscale, h;
+        double volume = 1.0;
+        for (int d = 0; d < 3; d++) {
+            offset[d] = global_grid.globalOffset(d) - own_nodes.min(d);
+            num_node[d] = global_grid.globalNumEntity(Cabana::Grid::Node(), d);
+            kscale[d] = 2.0 * Kokkos::numbers::pi_v<double> / _spatial.width()[d];
+            h[d] = _spatial.cellSize()[d];
+            volume *= h[d];
+        }
+        double alpha2 = _alpha * _alpha;
+        Kokkos::parallel_for("P3M BR Green's Function",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            int index[3] = {i + offset[0], j + offset[1], k + offset[2]};
+            double kv[3], k2 = 0.0, window = 1.0;
+            bool nyquist = false;
+            for (int d = 0; d < 3; d++) {
+                int m = index[d];
+                if (2 * m == num_node[d]) nyquist = true;
+                if (2 * m > num_node[d]) m -= num_node[d];
+                kv[d] = m * kscale[d];
+                k2 += kv[d] * kv[d];
+                double arg = 0.5 * kv[d] * h[d];
+                double sinc = (m == 0) ? 1.0 : Kokkos::sin(arg) / arg;
+                window *= sinc * sinc;
+            }
+            if (k2 == 0.0 || nyquist) {
+                for (int c = 0; c < 2; c++) {
+                    s0(i, j, k, c) = 0.0;
+                    s1(i, j, k, c) = 0.0;
+                    s2(i, j, k, c) = 0.0;
+                }
+                return;
+            }
+
+            double green = 4.0 * Kokkos::numbers::pi_v<double> * Kokkos::exp(-k2 / (4.0 * alpha2))
+                               / (k2 * window * window * volume);
+            double psi[2][3];
+            for (int c = 0; c < 2; c++) {
+                psi[c][0] = green * s0(i, j, k, c);
+                psi[c][1] = green * s1(i, j, k, c);
+                psi[c][2] = green * s2(i, j, k, c);
+            }
+            double curl[2][3];
+            Operators::cross(curl[0], kv, psi[0]);
+            Operators::cross(curl[1], kv, psi[1]);
+            // i (a + ib) = -b + ia
+            s0(i, j, k, 0) = -curl[1][0];
+            s1(i, j, k, 0) = -curl[1][1];
+            s2(i, j, k, 0) = -curl[1][2];
+            s0(i, j, k, 1) = curl[0][0];
+            s1(i, j, k, 1) = curl[0][1];
+            s2(i, j, k, 1) = curl[0][2];
+        });
+        for (int d = 0; d < 3; d++) {
+            _fft->reverse(*_spectral[d], Cabana::Grid::Experimental::FFTScaleFull());
+        }
+
+        Kokkos::parallel_for("P3M BR Store Mesh Velocity",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            field(i, j, k, 0) = s0(i, j, k, 0);
+            field(i, j, k, 1) = s1(i, j, k, 0);
+            field(i, j, k, 2) = s2(i, j, k, 0);
+        });
+
+        /* Interpolate the mesh velocity back with the same weights */
+        Kokkos::View<double**, device_type> far("P3M far velocity", num_owned, 3);
+        Cabana::Grid::g2p(*_field, *_field_halo, x, num_owned, Cabana::Grid::Spline<1>(),
+                          Cabana::Grid::createVectorValueG2P(far, 1.0));
+        Kokkos::parallel_for("P3M BR Combine",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            for (int d = 0; d < 3; d++) u(p, d) += far(p, d);
+        });
+        _spatial.correctSheetStrength(_particles, num_owned);
+    }
+
+    /* Compute the interface velocities with the P3M method */
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        double start = MPI_Wtime();
+        Kokkos::Profiling::pushRegion("P3M BR Distribute");
+        _spatial.createParticles(z, w, _particles);
+        _spatial.checkExtent(_particles);
+        _spatial.migrate(_particles);
+        int num_owned = _spatial.addGhosts(_particles, _cutoff);
+        Kokkos::Profiling::popRegion();
+        double distributed = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("P3M BR Short Range");
+        computeShortRange(num_owned);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double near = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("P3M BR Long Range");
+        computeLongRange(num_owned);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double far = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("P3M BR Return");
+        _spatial.returnVelocities(_particles, num_owned, zdot);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double returned = MPI_Wtime();
+
+        _comm_time += (distributed - start) + (returned - far);
+        _near_time += near - distributed;
+        _far_time += far - near;
+        _samples++;
+    }
+
+    /* Print the time spent moving particles and in the short and long
+     * range parts, taking the maximum across processes */
+    void printTimings(std::ostream & out) const override
+    {
+        if (_samples == 0) return;
+
+        double local[3] = {_comm_time, _near_time, _far_time}, global[3];
+        MPI_Reduce(local, global, 3, MPI_DOUBLE, MPI_MAX, 0, _spatial.comm());
+        if (_spatial.rank() != 0) return;
+
+        out << "===== P3M BR Timings (max over ranks) =====\n"
+            << "Communication: " << global[0] << " s, short range " << global[1]
+            << " s, long range " << global[2] << " s over " << _samples
+            << " calls (cutoff " << _cutoff << ", alpha " << _alpha << ")\n"
+            << "===========================================\n";
+    }
+
+  private:
+    double _epsilon;
+    double _cutoff;
+    double _alpha;
+    spatial_mesh_type _spatial;
+    mutable particle_type _particles;
+
+    std::shared_ptr<mesh_array_type> _field;
+    std::shared_ptr<halo_type> _field_halo;
+    std::shared_ptr<mesh_array_type> _spectral[3];
+    std::shared_ptr<fft_type> _fft;
+
+    mutable double _comm_time = 0.0, _near_time = 0.0, _far_time = 0.0;
+    mutable int _samples = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_P3MBRSOLVER_HPP
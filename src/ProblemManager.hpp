@@ -201,6 +201,29 @@ class ProblemManager
         return _vorticity->view();
     };
 
+    /**
+     * Return Position Array
+     * @param Location::Node
+     * @param Field::Position
+     * @return Returns the array storing the current position at nodes, for
+     * classes that pair it with temporary arrays of their own
+     **/
+    node_array & array( Cabana::Grid::Node, Field::Position ) const
+    {
+        return *_position;
+    };
+
+    /**
+     * Return Vorticity Array
+     * @param Location::Node
+     * @param Field::Vorticity
+     * @return Returns the array storing the current vorticity at nodes
+     **/
+    node_array & array( Cabana::Grid::Node, Field::Vorticity ) const
+    {
+        return *_vorticity;
+    };
+
     /**
      * Gather State Data from Neighbors
      **/
@@ -20,13 +20,23 @@
 #include <Mesh.hpp>
 #include <ProblemManager.hpp>
 #include <SiloWriter.hpp>
+#include <SolverParams.hpp>
 #include <TimeIntegrator.hpp>
+#include <BRSolverBase.hpp>
 #include <ExactBRSolver.hpp>
+#include <TreecodeBRSolver.hpp>
+#include <FMMBRSolver.hpp>
+#include <CutoffBRSolver.hpp>
+#include <P3MBRSolver.hpp>
+#include <VortexInCellBRSolver.hpp>
 
 #include <ZModel.hpp>
 
 #include <Kokkos_Core.hpp>
+#include <iostream>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include <mpi.h>
@@ -60,6 +70,41 @@ class SolverBase
  *    as const references.
  */
 
+//---------------------------------------------------------------------------//
+// Birkhoff-Rott solver creation method. The far-field solver is chosen at
+// runtime, so ZModel works through the BRSolverBase interface and new
+// engines only need to be added here.
+template <class ExecutionSpace, class MemorySpace>
+std::unique_ptr<BRSolverBase<ExecutionSpace, MemorySpace>>
+createBRSolver( const ProblemManager<ExecutionSpace, MemorySpace> & pm,
+                const BoundaryCondition & bc, const double epsilon,
+                const double dx, const double dy, const SolverParams & params )
+{
+    switch ( params.br_solver )
+    {
+      case BR_SOLVER_EXACT:
+        return std::make_unique<ExactBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+      case BR_SOLVER_TREECODE:
+        return std::make_unique<TreecodeBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+      case BR_SOLVER_FMM:
+        return std::make_unique<FMMBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+      case BR_SOLVER_CUTOFF:
+        return std::make_unique<CutoffBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+      case BR_SOLVER_P3M:
+        return std::make_unique<P3MBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+      case BR_SOLVER_VIC:
+        return std::make_unique<VortexInCellBRSolver<ExecutionSpace, MemorySpace>>(
+            pm, bc, epsilon, dx, dy, params );
+    }
+    throw std::runtime_error( "invalid BR solver" );
+}
+
+//---------------------------------------------------------------------------//
 template <class ExecutionSpace, class MemorySpace, class ModelOrder>
 class Solver : public SolverBase
 {
@@ -68,9 +113,7 @@ class Solver : public SolverBase
     using node_array =
         Cabana::Grid::Array<double, Cabana::Grid::Node, Cabana::Grid::UniformMesh<double, 2>, MemorySpace>;
 
-    // At some point we'll specify this when making the solver through a template argument.
-    // Still need to design that out XXX
-   using brsolver_type = ExactBRSolver<ExecutionSpace, MemorySpace>;  // Single node currently
+    using brsolver_type = BRSolverBase<ExecutionSpace, MemorySpace>;
 
     using zmodel_type = ZModel<ExecutionSpace, MemorySpace, ModelOrder, brsolver_type>;
     using ti_type = TimeIntegrator<ExecutionSpace, MemorySpace, zmodel_type>;
@@ -83,7 +126,8 @@ class Solver : public SolverBase
             const Cabana::Grid::BlockPartitioner<2>& partitioner,
             const double atwood, const double g, const InitFunc& create_functor,
             const BoundaryCondition& bc, const double mu, 
-            const double epsilon, const double delta_t)
+            const double epsilon, const double delta_t,
+            const SolverParams& params )
         : _halo_min( 2 )
         , _atwood( atwood )
         , _g( g )
@@ -92,6 +136,8 @@ class Solver : public SolverBase
         , _eps( epsilon )
         , _dt( delta_t )
         , _time( 0.0 )
+        , _t_final( std::numeric_limits<double>::infinity() )
+        , _params( params )
     {
 	std::array<bool, 2> periodic;
 
@@ -140,16 +186,24 @@ class Solver : public SolverBase
         _pm = std::make_unique<ProblemManager<ExecutionSpace, MemorySpace>>(
             *_mesh, _bc, create_functor );
 
-        // Create the Birkhoff-Rott solver (XXX make this conditional on non-low 
-        // order solve
-        _br = std::make_unique<brsolver_type>(*_pm, _bc, _eps, dx, dy);
+        // Create the Birkhoff-Rott solver if the model order uses one; the
+        // low order model gets a null solver
+        if constexpr ( zmodel_type::needs_br ) {
+            _br = createBRSolver<ExecutionSpace, MemorySpace>(*_pm, _bc, _eps, dx, dy, _params);
+        }
 
         // Create the ZModel solver
         _zm = std::make_unique<ZModel<ExecutionSpace, MemorySpace, ModelOrder, brsolver_type>>(
-            *_pm, _bc, _br.get(), dx, dy, _atwood, _g, _mu);
+            *_pm, _bc, _br.get(), dx, dy, _atwood, _g, _mu, _params);
 
         // Make a time integrator to move the zmodel forward
-        _ti = std::make_unique<TimeIntegrator<ExecutionSpace, MemorySpace, zmodel_type>>( *_pm, _bc, *_zm );
+        if ( _params.dt_tolerance > 0.0 && _params.time_scheme != TIME_TVD_RK3 ) {
+            throw std::invalid_argument( "Adaptive timestepping requires the TVD RK3 scheme" );
+        }
+        if ( _params.fuse_stages && ( _params.time_scheme != TIME_TVD_RK3 || _params.dt_tolerance > 0.0 ) ) {
+            throw std::invalid_argument( "Fused stage updates require fixed-step TVD RK3" );
+        }
+        _ti = std::make_unique<TimeIntegrator<ExecutionSpace, MemorySpace, zmodel_type>>( *_pm, _bc, *_zm, _params );
 
         // Set up Silo for I/O
         _silo = std::make_unique<SiloWriter<ExecutionSpace, MemorySpace>>( *_pm );
@@ -164,28 +218,44 @@ class Solver : public SolverBase
 
     void step() override
     {
-        _ti->step(_dt);
-        _time += _dt;
+        // Adaptive timestepping takes a step of at most _dt, shortened to
+        // land on the final time, and updates _dt to the size suggested for
+        // the next step
+        if ( _params.dt_tolerance > 0.0 ) {
+            double remaining = _t_final - _time;
+            double taken = _ti->adaptiveStep(_dt, _params.dt_tolerance, remaining);
+            _time = ( taken < remaining ) ? _time + taken : _t_final;
+        } else {
+            _ti->step(_dt);
+            _time += _dt;
+        }
     }
 
     void solve( const double t_final, const int write_freq ) override
     {
         int t = 0;
         int num_step;
+        bool adaptive = ( _params.dt_tolerance > 0.0 );
 
         Kokkos::Profiling::pushRegion( "Solve" );
+        _t_final = t_final;
 
         if (write_freq > 0) {
             _silo->siloWrite( strdup( "Mesh" ), t, _time, _dt );
         }
 
+        // Only fixed timesteps know in advance how many steps they take
         num_step = t_final / _dt;
 
         // Start advancing time.
         do
         {
-            if ( 0 == _mesh->rank() )
-                printf( "Step %d / %d at time = %f\n", t, num_step, _time );
+            if ( 0 == _mesh->rank() ) {
+                if ( adaptive )
+                    printf( "Step %d at time = %f, dt = %f\n", t, _time, _dt );
+                else
+                    printf( "Step %d / %d at time = %f, dt = %f\n", t, num_step, _time, _dt );
+            }
 
             step();
             t++;
@@ -196,6 +266,9 @@ class Solver : public SolverBase
             }
         } while ( ( _time < t_final ) );
         Kokkos::Profiling::popRegion();
+
+        // Report where the far-field solver spent its time
+        if ( _br ) _br->printTimings( std::cout );
     }
 
   private:
@@ -207,6 +280,8 @@ class Solver : public SolverBase
     double _mu, _eps;
     double _dt;
     double _time;
+    double _t_final;
+    SolverParams _params;
     
     std::unique_ptr<Mesh<ExecutionSpace, MemorySpace>> _mesh;
     std::unique_ptr<ProblemManager<ExecutionSpace, MemorySpace>> _pm;
@@ -230,7 +305,8 @@ createSolver( const std::string& device, MPI_Comm comm,
               const ModelOrder,
               const double mu,
               const double epsilon, 
-              const double delta_t )
+              const double delta_t,
+              const SolverParams& params = SolverParams() )
 {
     if ( 0 == device.compare( "serial" ) )
     {
@@ -238,7 +314,7 @@ createSolver( const std::string& device, MPI_Comm comm,
         return std::make_shared<
             Beatnik::Solver<Kokkos::Serial, Kokkos::HostSpace, ModelOrder>>(
             comm, global_bounding_box, global_num_cell, partitioner, atwood, g, 
-            create_functor, bc, mu, epsilon, delta_t);
+            create_functor, bc, mu, epsilon, delta_t, params);
 #else
         throw std::runtime_error( "Serial Backend Not Enabled" );
 #endif
@@ -249,7 +325,7 @@ createSolver( const std::string& device, MPI_Comm comm,
         return std::make_shared<
             Beatnik::Solver<Kokkos::Threads, Kokkos::HostSpace, ModelOrder>>(
             comm, global_bounding_box, global_num_cell, partitioner, atwood, g, 
-            create_functor, bc, mu, epsilon, delta_t);
+            create_functor, bc, mu, epsilon, delta_t, params);
 #else
         throw std::runtime_error( "Threads Backend Not Enabled" );
 #endif
@@ -260,7 +336,7 @@ createSolver( const std::string& device, MPI_Comm comm,
         return std::make_shared<
             Beatnik::Solver<Kokkos::OpenMP, Kokkos::HostSpace, ModelOrder>>(
             comm, global_bounding_box, global_num_cell, partitioner, atwood, g, 
-            create_functor, bc, mu, epsilon, delta_t);
+            create_functor, bc, mu, epsilon, delta_t, params);
 #else
         throw std::runtime_error( "OpenMP Backend Not Enabled" );
 #endif
@@ -271,7 +347,7 @@ createSolver( const std::string& device, MPI_Comm comm,
         return std::make_shared<
             Beatnik::Solver<Kokkos::Cuda, Kokkos::CudaSpace, ModelOrder>>(
             comm, global_bounding_box, global_num_cell, partitioner, atwood, g, 
-            create_functor, bc, mu, epsilon, delta_t);
+            create_functor, bc, mu, epsilon, delta_t, params);
 #else
         throw std::runtime_error( "CUDA Backend Not Enabled" );
 #endif
@@ -282,7 +358,7 @@ createSolver( const std::string& device, MPI_Comm comm,
         return std::make_shared<Beatnik::Solver<Kokkos::Experimental::HIP, 
             Kokkos::Experimental::HIPSpace, ModelOrder>>(
                 comm, global_bounding_box, global_num_cell, partitioner, atwood, g, 
-                create_functor, bc, mu, epsilon, delta_t);
+                create_functor, bc, mu, epsilon, delta_t, params);
 #else
         throw std::runtime_error( "HIP Backend Not Enabled" );
 #endif
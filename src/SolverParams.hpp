@@ -0,0 +1,99 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file SolverParams.hpp
+ *
+ * @section DESCRIPTION
+ * Tuning parameters for the numerical methods used by the solver. These don't
+ * change the problem being solved, only how it is solved, and are passed
+ * down from the solver to the objects that use them.
+ */
+
+#ifndef BEATNIK_SOLVERPARAMS_HPP
+#define BEATNIK_SOLVERPARAMS_HPP
+
+#include <string>
+
+namespace Beatnik
+{
+
+/**
+ * @enum BRSolverEngine
+ * @brief Method used to compute the Birkhoff-Rott far-field velocity
+ */
+enum BRSolverEngine
+{
+    BR_SOLVER_EXACT = 0, /**< All-pairs sum with ring communication */
+    BR_SOLVER_TREECODE = 1, /**< Barnes-Hut treecode */
+    BR_SOLVER_FMM = 2, /**< Fast multipole method */
+    BR_SOLVER_CUTOFF = 3, /**< Sum over neighbors within a cutoff */
+    BR_SOLVER_P3M = 4, /**< Particle-particle/particle-mesh Ewald (periodic only) */
+    BR_SOLVER_VIC = 5, /**< Vortex-in-cell on a spatial mesh */
+};
+
+/**
+ * @enum BRKernel
+ * @brief Kernel used by the exact BR solver to compute the velocity a block
+ * of sources induces on the owned interface points
+ */
+enum BRKernel
+{
+    BR_KERNEL_FLAT = 0, /**< One thread per point/source pair, atomic accumulation */
+    BR_KERNEL_TEAM = 1, /**< One team per point reducing over sources, no atomics */
+    BR_KERNEL_TILED = 2, /**< Teams of points reusing source tiles staged in scratch */
+    BR_KERNEL_SIMD = 3, /**< Explicit SIMD over sources on host backends */
+};
+
+/**
+ * @enum TimeScheme
+ * @brief Runge-Kutta scheme used to advance the interface in time
+ */
+enum TimeScheme
+{
+    TIME_TVD_RK3 = 0, /**< Three stage TVD RK3 with an embedded second order solution */
+    TIME_LS_SSP_RK104 = 1, /**< Ten stage fourth order SSP RK using two registers */
+    TIME_SSP_RK43 = 2, /**< Four stage third order SSP RK */
+    TIME_RK4 = 3, /**< Classic four stage fourth order RK */
+};
+
+/**
+ * @struct SolverParams
+ * @brief Struct which holds the solution method options, with defaults that
+ * match the behavior of the solver when they are not specified
+ */
+struct SolverParams
+{
+    /* Birkhoff-Rott far-field solver parameters */
+    BRSolverEngine br_solver = BR_SOLVER_EXACT; /**< Far-field velocity method */
+    bool br_symmetric = false; /**< Evaluate each exact BR pair interaction once */
+    BRKernel br_kernel = BR_KERNEL_FLAT; /**< Exact BR all-pairs kernel */
+    double br_theta = 0.5; /**< Treecode multipole acceptance opening angle */
+    int br_leaf_size = 32; /**< Maximum sources in a tree leaf cell */
+    int br_fmm_order = 4; /**< FMM expansion order */
+    bool br_fmm_check = false; /**< Compare FMM velocities to the exact solver */
+    double br_cutoff = 0.5; /**< Direct interaction cutoff distance of the cutoff and P3M BR solvers */
+    double br_mesh_spacing = 0.1; /**< Spatial mesh cell size of the P3M and vortex-in-cell BR solvers */
+
+    /* Reisz transform FFT parameters */
+    bool fft_autotune = false; /**< Time the HeFFTe plan options at startup and use the fastest */
+    std::string fft_tune_cache; /**< File caching autotuned plan options by mesh size and process count */
+
+    /* Time integration parameters */
+    TimeScheme time_scheme = TIME_TVD_RK3; /**< Runge-Kutta scheme */
+    bool fuse_stages = false; /**< Apply the TVD RK3 stage updates in the ZModel's final kernels */
+    bool implicit_viscosity = false; /**< Integrate the artificial viscosity spectrally (periodic only) */
+    double dt_tolerance = 0.0; /**< Local error tolerance of adaptive timestepping, fixed timestep if zero */
+    double dt_max = 0.0; /**< Largest adaptive timestep, unlimited if zero */
+};
+
+} // namespace Beatnik
+
+#endif // BEATNIK_SOLVERPARAMS_HPP
@@ -0,0 +1,514 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file SpatialMesh.hpp
+ *
+ * @section DESCRIPTION
+ * Spatial decomposition used by the far-field solvers that work on the
+ * physical location of the interface rather than its surface mesh. The
+ * bounding box of the problem is covered by a 3D Cabana grid that is
+ * decomposed into blocks in x and y (the interface is a surface spanning
+ * x/y, so z is not split). Interface points are turned into Cabana
+ * particles carrying their position and quadrature-weighted vorticity,
+ * migrated to the process owning their location, optionally ghosted to
+ * nearby processes, and finally sent back to the surface mesh process that
+ * owns them with the velocity computed for them.
+ */
+
+#ifndef BEATNIK_SPATIALMESH_HPP
+#define BEATNIK_SPATIALMESH_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <mpi.h>
+
+#include <BoundaryCondition.hpp>
+#include <BRSources.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The SpatialMesh Class
+ * @class SpatialMesh
+ * @brief 3D spatial decomposition of the problem domain and the particle
+ * representation of the interface that lives on it
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class SpatialMesh
+{
+  public:
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using surface_mesh_type = Cabana::Grid::UniformMesh<double, 2>;
+    using mesh_type = Cabana::Grid::UniformMesh<double, 3>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    /* Interface particles: position, weighted vorticity, velocity, and the
+     * surface mesh process and owned node index the point came from */
+    using particle_members = Cabana::MemberTypes<double[3], double[3], double[3], int, int>;
+    using particle_type = Cabana::AoSoA<particle_members, MemorySpace>;
+    enum { Position = 0, Vorticity = 1, Velocity = 2, OriginRank = 3, OriginIndex = 4 };
+
+    /* Neighbor list of the owned particles over owned and ghost particles */
+    using neighbor_list_type = Cabana::VerletList<MemorySpace, Cabana::FullNeighborTag,
+                                                  Cabana::VerletLayoutCSR, Cabana::TeamOpTag>;
+
+    /* Create a spatial mesh over the problem bounding box with cells of
+     * roughly the given size and the given halo width in cells. A mesh
+     * meant for FFTs is periodic in every dimension, so it is padded by the
+     * size of the bounding box on each side along the dimensions in which
+     * the interface is not periodic (always z). */
+    SpatialMesh( const pm_type & pm, const BoundaryCondition & bc,
+                 const double dx, const double dy,
+                 const double cell_size, const int halo_width,
+                 const bool fft_mesh = false )
+        : _pm( pm )
+        , _dx( dx )
+        , _dy( dy )
+    {
+        MPI_Comm surface_comm = _pm.mesh().localGrid()->globalGrid().comm();
+        int num_procs;
+        MPI_Comm_size(surface_comm, &num_procs);
+
+        std::array<bool, 3> periodic = {bc.isPeriodicBoundary({1, 0}),
+                                        bc.isPeriodicBoundary({0, 1}), false};
+        for (int d = 0; d < 3; d++) _periodic[d] = periodic[d];
+
+        auto low = _pm.mesh().boundingBoxMin();
+        auto high = _pm.mesh().boundingBoxMax();
+        std::array<int, 3> num_cell;
+        for (int d = 0; d < 3; d++) {
+            if (fft_mesh && !periodic[d]) {
+                double size = high[d] - low[d];
+                low[d] -= size;
+                high[d] += size;
+                periodic[d] = true;
+            }
+            _low[d] = low[d];
+            _width[d] = high[d] - low[d];
+            num_cell[d] = std::max(1, int(std::lround(_width[d] / cell_size)));
+            _cell_size[d] = _width[d] / num_cell[d];
+        }
+
+        /* Split the domain in x and y only */
+        int dims[2] = {0, 0};
+        MPI_Dims_create(num_procs, 2, dims);
+        Cabana::Grid::ManualBlockPartitioner<3> partitioner({dims[0], dims[1], 1});
+
+        auto global_mesh = Cabana::Grid::createUniformGlobalMesh(low, high, num_cell);
+        auto global_grid = Cabana::Grid::createGlobalGrid(surface_comm, global_mesh,
+                                                          periodic, partitioner);
+        _local_grid = Cabana::Grid::createLocalGrid(global_grid, halo_width);
+        _comm = global_grid->comm();
+        MPI_Comm_rank(_comm, &_rank);
+
+        /* Record the first cell of every block in x and y, and which process
+         * each block belongs to, so points can find their owner on the device */
+        for (int d = 0; d < 2; d++) {
+            _num_blocks[d] = global_grid->dimNumBlock(d);
+            _block_offsets[d] = Kokkos::View<int*, device_type>("block offsets", _num_blocks[d] + 1);
+        }
+        int mine[4] = {global_grid->dimBlockId(0), global_grid->dimBlockId(1),
+                       global_grid->globalOffset(0), global_grid->globalOffset(1)};
+        std::vector<int> all(4 * num_procs);
+        MPI_Allgather(mine, 4, MPI_INT, all.data(), 4, MPI_INT, _comm);
+        for (int d = 0; d < 2; d++) {
+            auto offsets = Kokkos::create_mirror_view(_block_offsets[d]);
+            for (int r = 0; r < num_procs; r++) offsets(all[4 * r + d]) = all[4 * r + d + 2];
+            offsets(_num_blocks[d]) = num_cell[d];
+            Kokkos::deep_copy(_block_offsets[d], offsets);
+        }
+        _block_ranks = Kokkos::View<int**, device_type>("block ranks", _num_blocks[0], _num_blocks[1]);
+        auto block_ranks = Kokkos::create_mirror_view(_block_ranks);
+        for (int i = 0; i < _num_blocks[0]; i++) {
+            for (int j = 0; j < _num_blocks[1]; j++) {
+                block_ranks(i, j) = global_grid->blockRank(std::array<int, 3>{i, j, 0});
+            }
+        }
+        Kokkos::deep_copy(_block_ranks, block_ranks);
+    }
+
+    const std::shared_ptr<Cabana::Grid::LocalGrid<mesh_type>> localGrid() const
+    {
+        return _local_grid;
+    }
+
+    MPI_Comm comm() const { return _comm; }
+    int rank() const { return _rank; }
+    const Kokkos::Array<bool, 3> & periodic() const { return _periodic; }
+    const Kokkos::Array<double, 3> & low() const { return _low; }
+    const Kokkos::Array<double, 3> & width() const { return _width; }
+    const Kokkos::Array<double, 3> & cellSize() const { return _cell_size; }
+
+    /* Stop if the interface has left the mesh along a dimension in which
+     * it is not periodic, since its points could not be spread to it */
+    void checkExtent(const particle_type & particles) const
+    {
+        auto x = Cabana::slice<Position>(particles);
+        double extent[6];
+        for (int d = 0; d < 3; d++) {
+            Kokkos::MinMaxScalar<double> bounds;
+            Kokkos::parallel_reduce("Spatial Mesh Extent",
+                Kokkos::RangePolicy<ExecutionSpace>(0, particles.size()),
+                KOKKOS_LAMBDA(const int p, Kokkos::MinMaxScalar<double> & b) {
+                b.min_val = Kokkos::min(b.min_val, x(p, d));
+                b.max_val = Kokkos::max(b.max_val, x(p, d));
+            }, Kokkos::MinMax<double>(bounds));
+            extent[2 * d] = -bounds.min_val;
+            extent[2 * d + 1] = bounds.max_val;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, extent, 6, MPI_DOUBLE, MPI_MAX, _comm);
+        for (int d = 0; d < 3; d++) {
+            if (_periodic[d]) continue;
+            if (-extent[2 * d] < _low[d] + _cell_size[d]
+                || extent[2 * d + 1] > _low[d] + _width[d] - _cell_size[d]) {
+                throw std::runtime_error("Interface has left the spatial mesh");
+            }
+        }
+    }
+
+    /* Block holding a cell index along one dimension */
+    template <class OffsetView>
+    static KOKKOS_INLINE_FUNCTION
+    int blockOf(OffsetView offsets, int num_blocks, int cell)
+    {
+        int b = 0;
+        while (b < num_blocks - 1 && cell >= offsets(b + 1)) b++;
+        return b;
+    }
+
+    /* Turn the surface nodes we own into particles, with positions wrapped
+     * into the domain along periodic dimensions */
+    void createParticles(node_view z, node_view w, particle_type & particles) const
+    {
+        auto local_L2G = Cabana::Grid::IndexConversion::createL2G(*_pm.mesh().localGrid(), Cabana::Grid::Node());
+        auto own_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        particles.resize(own_space.size());
+
+        auto x = Cabana::slice<Position>(particles);
+        auto omega = Cabana::slice<Vorticity>(particles);
+        auto u = Cabana::slice<Velocity>(particles);
+        auto origin_rank = Cabana::slice<OriginRank>(particles);
+        auto origin_index = Cabana::slice<OriginIndex>(particles);
+
+        double dx = _dx, dy = _dy;
+        int rank = _rank;
+        int kmin = own_space.min(0), lmin = own_space.min(1);
+        int lwidth = own_space.extent(1);
+        int num_nodes = _pm.mesh().get_mesh_size();
+        auto low = _low;
+        auto width = _width;
+        auto periodic = _periodic;
+
+        Kokkos::parallel_for("Spatial Mesh Create Particles",
+            Cabana::Grid::createExecutionPolicy(own_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int k, int l) {
+            int li[2] = {k, l};
+            int gi[2] = {0, 0};
+            local_L2G(li, gi);
+
+            double strength[3];
+            BRSources<ExecutionSpace, MemorySpace>::strength(strength, z, w, k, l, gi,
+                                                             num_nodes, dx, dy);
+
+            int s = (k - kmin) * lwidth + (l - lmin);
+            for (int d = 0; d < 3; d++) {
+                double pos = z(k, l, d);
+                if (periodic[d]) {
+                    pos -= width[d] * Kokkos::floor((pos - low[d]) / width[d]);
+                }
+                x(s, d) = pos;
+                omega(s, d) = strength[d];
+                u(s, d) = 0.0;
+            }
+            origin_rank(s) = rank;
+            origin_index(s) = s;
+        });
+    }
+
+    /* Move each particle to the process whose block contains it. Blocks on
+     * the edge of the domain own everything beyond it. */
+    void migrate(particle_type & particles) const
+    {
+        auto x = Cabana::slice<Position>(particles);
+        Kokkos::View<int*, MemorySpace> export_ranks("export ranks", particles.size());
+        auto offsets_x = _block_offsets[0];
+        auto offsets_y = _block_offsets[1];
+        auto block_ranks = _block_ranks;
+        int nbx = _num_blocks[0], nby = _num_blocks[1];
+        auto low = _low;
+        auto cell_size = _cell_size;
+
+        Kokkos::parallel_for("Spatial Mesh Owner",
+            Kokkos::RangePolicy<ExecutionSpace>(0, particles.size()),
+            KOKKOS_LAMBDA(const int p) {
+            int cx = int(Kokkos::floor((x(p, 0) - low[0]) / cell_size[0]));
+            int cy = int(Kokkos::floor((x(p, 1) - low[1]) / cell_size[1]));
+            export_ranks(p) = block_ranks(blockOf(offsets_x, nbx, cx), blockOf(offsets_y, nby, cy));
+        });
+
+        Cabana::Distributor<MemorySpace> distributor(_comm, export_ranks);
+        Cabana::migrate(distributor, particles);
+    }
+
+    /* Finds every (process, periodic image) a particle has to be ghosted
+     * to: the blocks within the ghost distance of the particle or of one of
+     * its periodic images, other than the block that owns it */
+    template <class PositionSlice, class OffsetView, class RankView>
+    struct GhostFinder
+    {
+        PositionSlice x;
+        OffsetView offsets_x, offsets_y;
+        RankView block_ranks;
+        int nbx, nby, rank;
+        Kokkos::Array<double, 3> low, width, cell_size;
+        Kokkos::Array<bool, 3> periodic;
+        Kokkos::Array<int, 3> num_cell;
+        double distance;
+
+        template <class Visitor>
+        KOKKOS_INLINE_FUNCTION void operator()(const int p, Visitor & visit) const
+        {
+            for (int sx = (periodic[0] ? -1 : 0); sx <= (periodic[0] ? 1 : 0); sx++) {
+                for (int sy = (periodic[1] ? -1 : 0); sy <= (periodic[1] ? 1 : 0); sy++) {
+                    double pos[2] = {x(p, 0) + sx * width[0], x(p, 1) + sy * width[1]};
+                    int shift[2] = {sx, sy};
+                    int range[2][2];
+                    bool overlaps = true;
+                    for (int d = 0; d < 2; d++) {
+                        range[d][0] = int(Kokkos::floor((pos[d] - distance - low[d]) / cell_size[d]));
+                        range[d][1] = int(Kokkos::floor((pos[d] + distance - low[d]) / cell_size[d]));
+                        if (shift[d] != 0 && (range[d][1] < 0 || range[d][0] > num_cell[d] - 1)) {
+                            overlaps = false;
+                        }
+                    }
+                    if (!overlaps) continue;
+
+                    int bx0 = blockOf(offsets_x, nbx, range[0][0]);
+                    int bx1 = blockOf(offsets_x, nbx, range[0][1]);
+                    int by0 = blockOf(offsets_y, nby, range[1][0]);
+                    int by1 = blockOf(offsets_y, nby, range[1][1]);
+                    for (int bx = bx0; bx <= bx1; bx++) {
+                        for (int by = by0; by <= by1; by++) {
+                            int r = block_ranks(bx, by);
+                            if (r == rank && sx == 0 && sy == 0) continue;
+                            visit(r, sx, sy);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    /* Append copies of the owned particles to the processes whose blocks
+     * are within the given distance of them, including periodic images
+     * with their positions shifted by the domain width. Returns the number
+     * of owned particles, which stay at the front. */
+    int addGhosts(particle_type & particles, const double distance) const
+    {
+        int num_owned = particles.size();
+        auto x = Cabana::slice<Position>(particles);
+        auto width = _width;
+
+        GhostFinder<decltype(x), Kokkos::View<int*, device_type>,
+                    Kokkos::View<int**, device_type>> find;
+        find.x = x;
+        find.offsets_x = _block_offsets[0];
+        find.offsets_y = _block_offsets[1];
+        find.block_ranks = _block_ranks;
+        find.nbx = _num_blocks[0];
+        find.nby = _num_blocks[1];
+        find.rank = _rank;
+        find.low = _low;
+        find.width = _width;
+        find.cell_size = _cell_size;
+        find.periodic = _periodic;
+        for (int d = 0; d < 3; d++) {
+            find.num_cell[d] = _local_grid->globalGrid().globalNumEntity(Cabana::Grid::Cell(), d);
+        }
+        find.distance = distance;
+
+        Kokkos::View<int*, MemorySpace> counts("ghost counts", num_owned + 1);
+        Kokkos::parallel_for("Spatial Mesh Count Ghosts",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            int n = 0;
+            auto count = [&](int, int, int) { n++; };
+            find(p, count);
+            counts(p) = n;
+        });
+        int num_export = 0;
+        Kokkos::parallel_scan("Spatial Mesh Ghost Offsets",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned + 1),
+            KOKKOS_LAMBDA(const int p, int & sum, const bool final) {
+            int n = counts(p);
+            if (final) counts(p) = sum;
+            sum += n;
+        }, num_export);
+
+        particle_type exports("ghost exports", num_export);
+        Kokkos::View<int*, MemorySpace> export_ranks("ghost ranks", num_export);
+        Kokkos::parallel_for("Spatial Mesh Fill Ghosts",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            int e = counts(p);
+            auto fill = [&](int r, int sx, int sy) {
+                auto tuple = particles.getTuple(p);
+                Cabana::get<Position>(tuple, 0) += sx * width[0];
+                Cabana::get<Position>(tuple, 1) += sy * width[1];
+                exports.setTuple(e, tuple);
+                export_ranks(e) = r;
+                e++;
+            };
+            find(p, fill);
+        });
+
+        Cabana::Distributor<MemorySpace> distributor(_comm, export_ranks);
+        particle_type ghosts("ghosts", distributor.totalNumImport());
+        Cabana::migrate(distributor, exports, ghosts);
+
+        particles.resize(num_owned + ghosts.size());
+        Kokkos::parallel_for("Spatial Mesh Append Ghosts",
+            Kokkos::RangePolicy<ExecutionSpace>(0, ghosts.size()),
+            KOKKOS_LAMBDA(const int g) {
+            particles.setTuple(num_owned + g, ghosts.getTuple(g));
+        });
+        return num_owned;
+    }
+
+    /* Build the list of particles within the cutoff of each of the first
+     * num_owned particles, binning every particle we have, ghosts included */
+    neighbor_list_type createNeighborList(const particle_type & particles, const int num_owned,
+                                          const double cutoff) const
+    {
+        auto x = Cabana::slice<Position>(particles);
+        std::array<double, 3> grid_min = {0.0, 0.0, 0.0}, grid_max = {1.0, 1.0, 1.0};
+        int num_particles = particles.size();
+        for (int d = 0; d < 3 && num_particles > 0; d++) {
+            Kokkos::MinMaxScalar<double> bounds;
+            Kokkos::parallel_reduce("Spatial Mesh Particle Bounds",
+                Kokkos::RangePolicy<ExecutionSpace>(0, num_particles),
+                KOKKOS_LAMBDA(const int p, Kokkos::MinMaxScalar<double> & b) {
+                b.min_val = Kokkos::min(b.min_val, x(p, d));
+                b.max_val = Kokkos::max(b.max_val, x(p, d));
+            }, Kokkos::MinMax<double>(bounds));
+            grid_min[d] = bounds.min_val - cutoff;
+            grid_max[d] = bounds.max_val + cutoff;
+        }
+        return neighbor_list_type(x, 0, num_owned, cutoff, 1.0, grid_min, grid_max);
+    }
+
+    /* An FFT mesh is periodic in z only because it is padded, and its
+     * kx = ky = 0 modes hold the vorticity averaged over x and y. A net
+     * sheet strength there makes the velocity jump across the interface
+     * rather than decay, and the periodic solution misses the linear shear
+     * across the mesh this gives the free solution, along with the offset
+     * from the first moment of the strength in z. Add both to the velocity
+     * of the first num_owned particles, in the same units as the mesh solves
+     * for -laplacian psi = 4 pi omega, as in the Yeh-Berkowitz slab
+     * correction. With free boundaries in x and y the interface is finite
+     * and padded in every direction, so nothing is added. */
+    void correctSheetStrength(particle_type & particles, const int num_owned) const
+    {
+        if (!_periodic[0] || !_periodic[1]) return;
+
+        /* Net strength of the x and y vorticity, then its moment in z */
+        auto x = Cabana::slice<Position>(particles);
+        auto omega = Cabana::slice<Vorticity>(particles);
+        double moments[4];
+        for (int m = 0; m < 4; m++) {
+            int c = m % 2;
+            bool first = (m >= 2);
+            moments[m] = 0.0;
+            Kokkos::parallel_reduce("Spatial Mesh Sheet Strength",
+                Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+                KOKKOS_LAMBDA(const int p, double & sum) {
+                sum += first ? omega(p, c) * x(p, 2) : omega(p, c);
+            }, moments[m]);
+        }
+        MPI_Allreduce(MPI_IN_PLACE, moments, 4, MPI_DOUBLE, MPI_SUM, _comm);
+
+        /* du_x/dz = 4 pi omega_y and du_y/dz = -4 pi omega_x, averaged over
+         * the mesh volume */
+        double scale = 4.0 * Kokkos::numbers::pi_v<double> / (_width[0] * _width[1] * _width[2]);
+        double strength_x = scale * moments[0], strength_y = scale * moments[1];
+        double moment_x = scale * moments[2], moment_y = scale * moments[3];
+        auto u = Cabana::slice<Velocity>(particles);
+        Kokkos::parallel_for("Spatial Mesh Sheet Correction",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            u(p, 0) += strength_y * x(p, 2) - moment_y;
+            u(p, 1) -= strength_x * x(p, 2) - moment_x;
+        });
+    }
+
+    /* Send the first num_owned particles back to the surface mesh process
+     * they came from and store their velocities in the interface velocity */
+    void returnVelocities(particle_type & particles, const int num_owned, node_view zdot) const
+    {
+        particles.resize(num_owned);
+        auto origin_rank = Cabana::slice<OriginRank>(particles);
+        Kokkos::View<int*, MemorySpace> export_ranks("return ranks", num_owned);
+        Kokkos::parallel_for("Spatial Mesh Return Ranks",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_owned),
+            KOKKOS_LAMBDA(const int p) {
+            export_ranks(p) = origin_rank(p);
+        });
+        Cabana::Distributor<MemorySpace> distributor(_comm, export_ranks);
+        Cabana::migrate(distributor, particles);
+
+        auto own_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto u = Cabana::slice<Velocity>(particles);
+        auto origin_index = Cabana::slice<OriginIndex>(particles);
+        int kmin = own_space.min(0), lmin = own_space.min(1);
+        int lwidth = own_space.extent(1);
+        Kokkos::parallel_for("Spatial Mesh Store Velocities",
+            Kokkos::RangePolicy<ExecutionSpace>(0, particles.size()),
+            KOKKOS_LAMBDA(const int p) {
+            int s = origin_index(p);
+            int k = kmin + s / lwidth, l = lmin + s % lwidth;
+            for (int d = 0; d < 3; d++) {
+                zdot(k, l, d) = u(p, d);
+            }
+        });
+    }
+
+  private:
+    const pm_type & _pm;
+    double _dx, _dy;
+    Kokkos::Array<double, 3> _low, _width, _cell_size;
+    Kokkos::Array<bool, 3> _periodic;
+    std::shared_ptr<Cabana::Grid::LocalGrid<mesh_type>> _local_grid;
+    MPI_Comm _comm;
+    int _rank;
+
+    /* First cell of each block in x and y and the process owning each block */
+    Kokkos::Array<int, 2> _num_blocks;
+    Kokkos::View<int*, device_type> _block_offsets[2];
+    Kokkos::View<int**, device_type> _block_ranks;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_SPATIALMESH_HPP
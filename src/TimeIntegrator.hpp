@@ -14,15 +14,65 @@
 
 #include <BoundaryCondition.hpp>
 #include <ProblemManager.hpp>
+#include <SolverParams.hpp>
 #include <ZModel.hpp>
 
 #include <Cabana_Grid.hpp>
 
 #include <Kokkos_Core.hpp>
 
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <mpi.h>
+
 namespace Beatnik
 {
 
+/* One stage of a Runge-Kutta scheme in a two-register Shu-Osher form. The
+ * derivative F is computed at the stage state U, and then the next stage 
+ * state and the register P are
+ *   U' = u[0] * U0 + u[1] * P + u[2] * U + u[3] * dt * F
+ *   P' = p[0] * U0 + p[1] * P + p[2] * U + p[3] * dt * F
+ * where U0 is the state at the start of the step. The last stage's U' is
+ * the new state. Stages of schemes that use P must carry it forward with
+ * p = {0, 1, 0, 0} when they don't change it. */
+struct RKStage
+{
+    double u[4];
+    double p[4];
+};
+
+/* Stage tables of the Runge-Kutta schemes the time integrator can use. The
+ * low-storage SSPRK(10,4) is applied in place by stepLowStorage rather than
+ * through a table, so it has no stages here. */
+inline std::vector<RKStage> rkStages( TimeScheme scheme )
+{
+    const double sixth = 1.0 / 6.0;
+    switch ( scheme ) {
+    case TIME_TVD_RK3:
+        return { { {1.0, 0.0, 0.0, 1.0}, {} },
+                 { {0.75, 0.0, 0.25, 0.25}, {} },
+                 { {1.0 / 3.0, 0.0, 2.0 / 3.0, 2.0 / 3.0}, {} } };
+    case TIME_SSP_RK43:
+        // Four stage third order SSP, SSP coefficient 2
+        return { { {0.0, 0.0, 1.0, 0.5}, {} },
+                 { {0.0, 0.0, 1.0, 0.5}, {} },
+                 { {2.0 / 3.0, 0.0, 1.0 / 3.0, sixth}, {} },
+                 { {0.0, 0.0, 1.0, 0.5}, {} } };
+    case TIME_LS_SSP_RK104:
+        return {};
+    case TIME_RK4:
+        // Classic RK4, accumulating the weighted derivatives in P
+        return { { {1.0, 0.0, 0.0, 0.5}, {1.0, 0.0, 0.0, sixth} },
+                 { {1.0, 0.0, 0.0, 0.5}, {0.0, 1.0, 0.0, 2.0 * sixth} },
+                 { {1.0, 0.0, 0.0, 1.0}, {0.0, 1.0, 0.0, 2.0 * sixth} },
+                 { {0.0, 1.0, 0.0, sixth}, {} } };
+    }
+    throw std::invalid_argument( "invalid time integration scheme" );
+}
+
 // The time integrator requires temporary state for runge kutta interpolation
 // which are stored as part of this object 
 template <class ExecutionSpace, class MemorySpace, class ZModelType>
@@ -34,16 +84,23 @@ class TimeIntegrator
     using node_array =
         Cabana::Grid::Array<double, Cabana::Grid::Node, Cabana::Grid::UniformMesh<double, 2>,
                       mem_space>;
+    using array_view = typename node_array::view_type;
+    using node_view = Kokkos::View<double***, device_type>;
 
 //    using halo_type = Cabana::Grid::Halo<MemorySpace>;
 
   public:
     TimeIntegrator( const ProblemManager<exec_space, mem_space> & pm,
                     const BoundaryCondition & bc,
-                    const ZModelType & zm )
+                    const ZModelType & zm,
+                    const SolverParams & params = SolverParams() )
     : _pm(pm)
     , _bc(bc)
     , _zm(zm)
+    , _scheme(params.time_scheme)
+    , _fused(params.fuse_stages)
+    , _dt_max(params.dt_max)
+    , _stages(rkStages(params.time_scheme))
     {
        
         // Create a layout of the temporary arrays we'll need for velocity
@@ -55,93 +112,353 @@ class TimeIntegrator
 
         _zdot = Cabana::Grid::createArray<double, mem_space>("velocity", 
                                                        node_triple_layout);
-        _wdot = Cabana::Grid::createArray<double, mem_space>("vorticity derivative",
-                                                       node_pair_layout);
-        _ztmp = Cabana::Grid::createArray<double, mem_space>("position temporary", 
-                                                       node_triple_layout);
-        _wtmp = Cabana::Grid::createArray<double, mem_space>("vorticity temporary", 
-                                                       node_pair_layout);
+        if (_scheme != TIME_LS_SSP_RK104) {
+            _wdot = Cabana::Grid::createArray<double, mem_space>("vorticity derivative",
+                                                           node_pair_layout);
+        }
+
+        // Adaptive steps keep the derivatives at the start of the step, which
+        // don't depend on the timestep, so rejected steps can reuse them
+        if (params.dt_tolerance > 0.0) {
+            _zdot0 = Cabana::Grid::createArray<double, mem_space>("initial velocity", 
+                                                            node_triple_layout);
+            _wdot0 = Cabana::Grid::createArray<double, mem_space>("initial vorticity derivative",
+                                                            node_pair_layout);
+        }
+
+        // The low-storage scheme works on the problem manager state in place,
+        // so beyond the velocity working space it only needs an unghosted 
+        // copy of the owned state, rather than a vorticity derivative and 
+        // haloed stage temporaries. The other schemes need those, and the 
+        // ones that use the second register P keep it unghosted too.
+        bool uses_register = (_scheme == TIME_LS_SSP_RK104);
+        for (auto & stage : _stages) {
+            if (stage.u[1] != 0.0) uses_register = true;
+            for (int k = 0; k < 4; k++) {
+                if (stage.p[k] != 0.0) uses_register = true;
+            }
+        }
+        if (uses_register) {
+            auto own_node_space = pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+            _zreg = node_view("position register", own_node_space.extent(0), own_node_space.extent(1), 3);
+            _wreg = node_view("vorticity register", own_node_space.extent(0), own_node_space.extent(1), 2);
+        }
+        if (_scheme != TIME_LS_SSP_RK104) {
+            _ztmp = Cabana::Grid::createArray<double, mem_space>("position temporary", 
+                                                           node_triple_layout);
+            _wtmp = Cabana::Grid::createArray<double, mem_space>("vorticity temporary", 
+                                                           node_pair_layout);
+        }
     }
 
+    /* Bounds on how much an adaptive step can change the timestep, and the
+     * safety factor applied to the optimal change the error estimate gives */
+    static constexpr double dt_safety = 0.9;
+    static constexpr double dt_min_factor = 0.2;
+    static constexpr double dt_max_factor = 2.0;
+
+    /* With implicit viscosity, the explicit step is Strang split between 
+     * two half steps of the spectral viscosity solve */
     void step( const double delta_t ) 
-    { 
-        // Compute the derivatives of position and vorticity at our current point
+    {
+        if (_zm.implicitViscosity()) _zm.applyImplicitViscosity( 0.5 * delta_t );
+        if (_scheme == TIME_LS_SSP_RK104) {
+            stepLowStorage( delta_t );
+        } else if (_fused) {
+            stepFused( delta_t );
+        } else {
+            computeStages( delta_t );
+            finishStep( delta_t );
+        }
+        if (_zm.implicitViscosity()) _zm.applyImplicitViscosity( 0.5 * delta_t );
+    }
+
+    /* TVD RK3 with each stage update applied by the ZModel in the kernels
+     * that compute the derivatives, so the derivatives are never written 
+     * out and read back. The ZModel can update the position in place but 
+     * not the vorticity, so the half step vorticity is kept in the 
+     * vorticity derivative array, which is otherwise unused here. */
+    void stepFused( const double delta_t )
+    {
+        using stage_type = typename ZModelType::StageUpdate;
+
         auto z_orig = _pm.get( Cabana::Grid::Node(), Field::Position() );
         auto w_orig = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
         auto z_tmp = _ztmp->view();
         auto w_tmp = _wtmp->view();
-//        auto & halo = _pm.halo(); 
+        auto w_half = _wdot->view();
+        auto z_dot = _zdot->view();
 
-        auto local_grid = _pm.mesh().localGrid();
+        // utmp = uold + du_dt * deltat
+        _zm.computeStage( stage_type{1.0, 0.0, delta_t, z_orig, w_orig, z_tmp, w_tmp}, z_dot );
 
-        // TVD RK3 Step One - derivative at forward euler point
-        auto z_dot = _zdot->view();
-        auto w_dot = _wdot->view();
+        // utmp = 3/4 uold + 1/4 utmp + 1/4 du_dt_tmp * deltat
+        _zm.computeStage( *_ztmp, *_wtmp, 
+            stage_type{0.75, 0.25, 0.25 * delta_t, z_orig, w_orig, z_tmp, w_half}, z_dot );
+
+        // unew = 1/3 uold + 2/3 utmp + 2/3 du_dt_tmp * deltat
+        _zm.computeStage( *_ztmp, *_wdot, 
+            stage_type{1.0 / 3.0, 2.0 / 3.0, 2.0 / 3.0 * delta_t, z_orig, w_orig, z_orig, w_orig}, z_dot );
+    }
 
-        // Find foward euler point using initial derivative. The zmodel solver
-	// uses the problem manager position and derivative by default.
-        _zm.computeDerivatives(z_dot, w_dot);
+    /* Ketcheson's two-register implementation of the ten stage, fourth order
+     * SSP Runge-Kutta method, which has an SSP coefficient of six. Every 
+     * stage updates the problem manager state in place, u = b * u + du_dt *
+     * deltat, which the ZModel applies in the kernels that compute the 
+     * derivatives. The only register is an unghosted copy of the owned 
+     * state, which holds the starting state and then the intermediate 
+     * combination of stage 5. The velocity array is still needed as the 
+     * ZModel's interface velocity working space. */
+    void stepLowStorage( const double delta_t )
+    {
+        auto z = _pm.get( Cabana::Grid::Node(), Field::Position() );
+        auto w = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+        auto z_save = _zreg;
+        auto w_save = _wreg;
 
+        auto local_grid = _pm.mesh().localGrid();
         auto own_node_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
-        Kokkos::parallel_for("RK3 Euler Step",
+        int imin = own_node_space.min(0), jmin = own_node_space.min(1);
+
+        // q2 = u
+        Kokkos::parallel_for("LSRK Save State",
+            Cabana::Grid::createExecutionPolicy(own_node_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j) {
+            for (int d = 0; d < 3; d++) z_save(i - imin, j - jmin, d) = z(i, j, d);
+            for (int d = 0; d < 2; d++) w_save(i - imin, j - jmin, d) = w(i, j, d);
+        });
+
+        // Stages 1-5: u = u + du_dt * deltat / 6
+        for (int s = 0; s < 5; s++) inPlaceStage( 1.0, delta_t / 6.0 );
+
+        // q2 = 1/25 q2 + 9/25 u, u = 15 q2 - 5 u
+        Kokkos::parallel_for("LSRK Combine",
             Cabana::Grid::createExecutionPolicy(own_node_space, ExecutionSpace()),
             KOKKOS_LAMBDA(int i, int j) {
             for (int d = 0; d < 3; d++) {
-	        z_tmp(i, j, d) = z_orig(i, j, d) + delta_t * z_dot(i, j, d);
+                double q = z_save(i - imin, j - jmin, d) / 25.0 + 9.0 / 25.0 * z(i, j, d);
+                z_save(i - imin, j - jmin, d) = q;
+                z(i, j, d) = 15.0 * q - 5.0 * z(i, j, d);
             }
             for (int d = 0; d < 2; d++) {
-	        w_tmp(i, j, d) = w_orig(i, j, d) + delta_t * w_dot(i, j, d);
+                double q = w_save(i - imin, j - jmin, d) / 25.0 + 9.0 / 25.0 * w(i, j, d);
+                w_save(i - imin, j - jmin, d) = q;
+                w(i, j, d) = 15.0 * q - 5.0 * w(i, j, d);
             }
         });
 
-        // Compute derivative at forward euler point from the temporaries
-        _zm.computeDerivatives( *_ztmp, *_wtmp, z_dot, w_dot);
- 
-        // TVD RK3 Step Two - derivative at half-step position
-        // derivatives
-        
-        // Take the half-step
-        Kokkos::parallel_for("RK3 Half Step",
+        // Stages 6-9: u = u + du_dt * deltat / 6
+        for (int s = 5; s < 9; s++) inPlaceStage( 1.0, delta_t / 6.0 );
+
+        // u = q2 + 3/5 u + 1/10 du_dt * deltat, as u = 3/5 u + 1/10 du_dt * 
+        // deltat followed by u = u + q2
+        inPlaceStage( 0.6, 0.1 * delta_t );
+        Kokkos::parallel_for("LSRK Final Stage",
+            Cabana::Grid::createExecutionPolicy(own_node_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j) {
+            for (int d = 0; d < 3; d++) z(i, j, d) += z_save(i - imin, j - jmin, d);
+            for (int d = 0; d < 2; d++) w(i, j, d) += w_save(i - imin, j - jmin, d);
+        });
+    }
+
+    /* Stage applied by the ZModel in place on the problem manager state,
+     * u = b * u + du_dt * deltat */
+    void inPlaceStage( const double b, const double delta_t )
+    {
+        using stage_type = typename ZModelType::StageUpdate;
+
+        auto z = _pm.get( Cabana::Grid::Node(), Field::Position() );
+        auto w = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+        _zm.computeStage( stage_type{0.0, b, delta_t, z, w, z, w}, _zdot->view() );
+    }
+
+    /* Take a step with local error control. TVD RK3 has an embedded second 
+     * order (Heun) solution, 2 * u2 - u, where u2 is the state at the half 
+     * step, so the difference between the two solutions estimates the local
+     * error without any extra derivative evaluations or storage. Steps whose
+     * error is above the tolerance are retried with a smaller timestep, 
+     * reusing the derivatives at the starting state. The step taken is at 
+     * most max_step and the largest timestep the integrator was configured
+     * with. Returns the timestep taken, and sets delta_t to the timestep 
+     * suggested for the next step. Implicit viscosity is applied once a step
+     * is accepted, since the size of the step isn't known before then, so 
+     * the splitting is only first order in this mode. */
+    double adaptiveStep( double & delta_t, const double tolerance, const double max_step )
+    {
+        if ( _dt_max > 0.0 && delta_t > _dt_max ) delta_t = _dt_max;
+        if ( delta_t > max_step ) delta_t = max_step;
+
+        evaluateStage( 0, _zdot0->view(), _wdot0->view() );
+        while ( true ) {
+            computeStages( delta_t, _zdot0->view(), _wdot0->view() );
+            double error = errorEstimate( delta_t, tolerance );
+
+            double factor = dt_max_factor;
+            if ( error > 0.0 ) factor = dt_safety * std::pow( error, -1.0 / 3.0 );
+            if ( !( factor >= dt_min_factor ) ) factor = dt_min_factor;
+            if ( factor > dt_max_factor ) factor = dt_max_factor;
+
+            if ( error <= 1.0 ) {
+                finishStep( delta_t );
+                if (_zm.implicitViscosity()) _zm.applyImplicitViscosity( delta_t );
+                double taken = delta_t;
+                delta_t *= factor;
+                if ( _dt_max > 0.0 && delta_t > _dt_max ) delta_t = _dt_max;
+                return taken;
+            }
+
+            delta_t *= factor;
+            if ( delta_t < 1e-12 ) {
+                throw std::runtime_error( "Adaptive timestep underflow" );
+            }
+        }
+    }
+
+    /* Compute all but the update of the last stage of the scheme, leaving
+     * the last stage state in the temporaries and the derivative there in 
+     * _zdot/_wdot. For TVD RK3 that's the state at the half step. */
+    void computeStages( const double delta_t ) 
+    { 
+        evaluateStage( 0 );
+        computeStages( delta_t, _zdot->view(), _wdot->view() );
+    }
+
+    /* The same, given the derivatives at the starting state */
+    void computeStages( const double delta_t, array_view z_dot0, array_view w_dot0 ) 
+    { 
+        int num_stages = _stages.size();
+        updateStage( 0, delta_t, z_dot0, w_dot0 );
+        for (int s = 1; s < num_stages - 1; s++) {
+            evaluateStage( s );
+            updateStage( s, delta_t );
+        }
+        evaluateStage( num_stages - 1 );
+    }
+
+    /* Compute the derivatives at the state of stage s, which is the problem
+     * manager state for the first stage and the temporaries after that */
+    void evaluateStage( const int s ) const
+    {
+        evaluateStage( s, _zdot->view(), _wdot->view() );
+    }
+
+    void evaluateStage( const int s, array_view z_dot, array_view w_dot ) const
+    {
+        if (s == 0) {
+            _zm.computeDerivatives( z_dot, w_dot );
+        } else {
+            _zm.computeDerivatives( *_ztmp, *_wtmp, z_dot, w_dot );
+        }
+    }
+
+    /* Apply the update of stage s using the derivatives computed at its 
+     * state. The last stage writes the problem manager state, and the others
+     * write the temporaries. Every update is pointwise, so reading and 
+     * writing the same array is safe. */
+    void updateStage( const int s, const double delta_t )
+    {
+        updateStage( s, delta_t, _zdot->view(), _wdot->view() );
+    }
+
+    void updateStage( const int s, const double delta_t, array_view z_dot, array_view w_dot )
+    {
+        int num_stages = _stages.size();
+        auto z_orig = _pm.get( Cabana::Grid::Node(), Field::Position() );
+        auto w_orig = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+        auto z_stage = (s == 0) ? z_orig : _ztmp->view();
+        auto w_stage = (s == 0) ? w_orig : _wtmp->view();
+        auto z_out = (s == num_stages - 1) ? z_orig : _ztmp->view();
+        auto w_out = (s == num_stages - 1) ? w_orig : _wtmp->view();
+        auto z_reg = _zreg;
+        auto w_reg = _wreg;
+        bool has_reg = _zreg.size() > 0;
+
+        Kokkos::Array<double, 4> cu, cp;
+        for (int k = 0; k < 4; k++) {
+            cu[k] = _stages[s].u[k];
+            cp[k] = _stages[s].p[k];
+        }
+
+        auto local_grid = _pm.mesh().localGrid();
+        auto own_node_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        int imin = own_node_space.min(0), jmin = own_node_space.min(1);
+
+        // unew = cu0 * uold + cu1 * p + cu2 * u + cu3 * du_dt * deltat, and likewise p
+        Kokkos::parallel_for("RK Stage Update",
             Cabana::Grid::createExecutionPolicy(own_node_space, ExecutionSpace()),
             KOKKOS_LAMBDA(int i, int j) {
             for (int d = 0; d < 3; d++) {
-	        z_tmp(i, j, d) = 0.75*z_orig(i, j, d) 
-                    + 0.25 * z_tmp(i, j, d) 
-                    + 0.25 * delta_t * z_dot(i, j, d);
+                double p = has_reg ? z_reg(i - imin, j - jmin, d) : 0.0;
+                double u0 = z_orig(i, j, d), u = z_stage(i, j, d);
+                double f = delta_t * z_dot(i, j, d);
+                z_out(i, j, d) = cu[0] * u0 + cu[1] * p + cu[2] * u + cu[3] * f;
+                if (has_reg) z_reg(i - imin, j - jmin, d) = cp[0] * u0 + cp[1] * p + cp[2] * u + cp[3] * f;
             }
             for (int d = 0; d < 2; d++) {
-	        w_tmp(i, j, d) = 0.75*w_orig(i, j, d) 
-                    + 0.25 * w_tmp(i, j, d) 
-                    + 0.25 * delta_t * w_dot(i, j, d);
+                double p = has_reg ? w_reg(i - imin, j - jmin, d) : 0.0;
+                double u0 = w_orig(i, j, d), u = w_stage(i, j, d);
+                double f = delta_t * w_dot(i, j, d);
+                w_out(i, j, d) = cu[0] * u0 + cu[1] * p + cu[2] * u + cu[3] * f;
+                if (has_reg) w_reg(i - imin, j - jmin, d) = cp[0] * u0 + cp[1] * p + cp[2] * u + cp[3] * f;
             }
         });
-        // Get the derivatives at the half-setp
-        _zm.computeDerivatives( *_ztmp, *_wtmp, z_dot, w_dot);
-        
-        // TVD RK3 Step Three - Combine start, forward euler, and half step
-        // derivatives to take the final full step.
-        // unew = 1/3 uold + 2/3 utmp + 2/3 du_dt_tmp * deltat
-        Kokkos::parallel_for("RK3 Full Step",
+    }
+
+    /* Largest error of the embedded second order solution over all of the 
+     * position and vorticity components, relative to tolerance * (1 + |u|),
+     * so that a step is acceptable if it's at most one */
+    double errorEstimate( const double delta_t, const double tolerance ) const
+    {
+        auto z_orig = _pm.get( Cabana::Grid::Node(), Field::Position() );
+        auto w_orig = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+        auto z_tmp = _ztmp->view();
+        auto w_tmp = _wtmp->view();
+        auto z_dot = _zdot->view();
+        auto w_dot = _wdot->view();
+
+        // unew - (2 utmp - uold) = 4/3 uold - 4/3 utmp + 2/3 du_dt_tmp * deltat
+        auto local_grid = _pm.mesh().localGrid();
+        auto own_node_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        double error = 0.0;
+        Kokkos::parallel_reduce("RK3 Error Estimate",
             Cabana::Grid::createExecutionPolicy(own_node_space, ExecutionSpace()),
-            KOKKOS_LAMBDA(int i, int j) {
+            KOKKOS_LAMBDA(int i, int j, double & lmax) {
             for (int d = 0; d < 3; d++) {
-	        z_orig(i, j, d) = ( 1.0 / 3.0 ) * z_orig(i, j, d) 
-                    + ( 2.0 / 3.0 ) * z_tmp(i, j, d) 
+                double e = ( 4.0 / 3.0 ) * ( z_orig(i, j, d) - z_tmp(i, j, d) )
                     + ( 2.0 / 3.0 ) * delta_t * z_dot(i, j, d);
+                double scaled = fabs(e) / ( tolerance * ( 1.0 + fabs(z_orig(i, j, d)) ) );
+                if (scaled > lmax) lmax = scaled;
             }
             for (int d = 0; d < 2; d++) {
-	        w_orig(i, j, d) = ( 1.0 / 3.0 ) * w_orig(i, j, d) 
-                    + ( 2.0 / 3.0 ) * w_tmp(i, j, d) 
+                double e = ( 4.0 / 3.0 ) * ( w_orig(i, j, d) - w_tmp(i, j, d) )
                     + ( 2.0 / 3.0 ) * delta_t * w_dot(i, j, d);
+                double scaled = fabs(e) / ( tolerance * ( 1.0 + fabs(w_orig(i, j, d)) ) );
+                if (scaled > lmax) lmax = scaled;
             }
-        });
+        }, Kokkos::Max<double>(error));
+
+        MPI_Allreduce( MPI_IN_PLACE, &error, 1, MPI_DOUBLE, MPI_MAX,
+                       local_grid->globalGrid().comm() );
+        return error;
+    }
+
+    /* Take the last stage update from the state left by computeStages */
+    void finishStep( const double delta_t )
+    {
+        updateStage( _stages.size() - 1, delta_t );
     }
 
   private:
     const ProblemManager<ExecutionSpace, MemorySpace> & _pm;
     const BoundaryCondition &_bc;
     const ZModelType & _zm;
+    TimeScheme _scheme;
+    bool _fused;
+    double _dt_max;
+    std::vector<RKStage> _stages;
     std::shared_ptr<node_array> _zdot, _wdot, _wtmp, _ztmp;
+    std::shared_ptr<node_array> _zdot0, _wdot0;
+    node_view _zreg, _wreg;
 };
 
 } // end namespace Beatnik
@@ -0,0 +1,302 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file TreecodeBRSolver.hpp
+ *
+ * @section DESCRIPTION
+ * Class that approximates the Birkhoff-Rott velocity integral with a
+ * Barnes-Hut treecode. The interface points are sorted into an octree in 3D
+ * space (see BRSourceTree), and each octree cell stores the total vorticity
+ * of the sources in it and their first moment about its center. Targets are
+ * distributed as in the surface mesh. Each process computes the expansions
+ * of a tree over its own points, exchanges the parts of it other processes
+ * need, and walks the resulting locally essential tree for the points it
+ * owns, using the far-field expansion of any cell which is small compared
+ * to its distance as seen from the target (the multipole acceptance
+ * criterion) and summing the remaining sources directly.
+ */
+
+#ifndef BEATNIK_TREECODEBRSOLVER_HPP
+#define BEATNIK_TREECODEBRSOLVER_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include <BRSolverBase.hpp>
+#include <BRSourceTree.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Operators.hpp>
+#include <SolverParams.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The TreecodeBRSolver Class
+ * @class TreecodeBRSolver
+ * @brief Approximates the Birkhoff-Rott integral in O(N log N) time using a
+ * Barnes-Hut octree with monopole and dipole cell expansions
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class TreecodeBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
+{
+  public:
+    using exec_space = ExecutionSpace;
+    using memory_space = MemorySpace;
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using mesh_type = Cabana::Grid::UniformMesh<double, 2>;
+
+    using node_view = Kokkos::View<double***, device_type>;
+    using tree_type = BRSourceTree<ExecutionSpace, MemorySpace>;
+    using moment_view = Kokkos::View<double**, Kokkos::LayoutLeft, device_type>;
+
+    /* Doubles stored for each tree cell expansion: total vorticity (0-2)
+     * and first vorticity moment D_ab = sum omega_a * delta_b about the 
+     * cell center (3-11, row-major) */
+    static constexpr int moment_size = 12;
+
+    TreecodeBRSolver( const pm_type & pm, const BoundaryCondition &bc,
+                      const double epsilon, const double dx, const double dy,
+                      const SolverParams & params = SolverParams() )
+        : _pm( pm )
+        , _epsilon( epsilon )
+        , _theta( params.br_theta )
+        , _leaf_size( params.br_leaf_size )
+        , _tree( pm, bc, dx, dy, params.br_leaf_size )
+    {
+        _comm = _pm.mesh().localGrid()->globalGrid().comm();
+        MPI_Comm_rank(_comm, &_rank);
+
+        if (_theta <= 0.0 || _leaf_size < 1) {
+            throw std::invalid_argument("Invalid treecode opening angle or leaf size");
+        }
+    }
+
+    /* Compute the expansion of each cell of a tree directly from its
+     * sources and the expansions of its remote cells, shifted to its center */
+    void computeMoments(const typename tree_type::Octree & tree, moment_view & out) const
+    {
+        int num_cells = tree.numCells();
+        out = moment_view(Kokkos::ViewAllocateWithoutInitializing("Treecode moments"),
+                          num_cells, moment_size);
+
+        auto moments = out;
+        auto links = tree.links;
+        auto geometry = tree.geometry;
+        auto sources = tree.sources;
+        auto remote = tree.remote;
+        constexpr int h = tree_type::remote_header;
+
+        Kokkos::parallel_for("Treecode BR Moments",
+            Kokkos::RangePolicy<ExecutionSpace>(0, num_cells),
+            KOKKOS_LAMBDA(const int c) {
+            double m[moment_size];
+            for (int n = 0; n < moment_size; n++) m[n] = 0.0;
+            for (int s = links(c, tree_type::LINK_BEGIN); s < links(c, tree_type::LINK_END); s++) {
+                double delta[3];
+                for (int d = 0; d < 3; d++) delta[d] = sources(s, d) - geometry(c, d);
+                for (int a = 0; a < 3; a++) {
+                    m[a] += sources(s, a + 3);
+                    for (int b = 0; b < 3; b++) {
+                        m[3 + 3 * a + b] += sources(s, a + 3) * delta[b];
+                    }
+                }
+            }
+            for (int q = links(c, tree_type::LINK_REMOTE_BEGIN); q < links(c, tree_type::LINK_REMOTE_END); q++) {
+                double delta[3];
+                for (int d = 0; d < 3; d++) delta[d] = remote(q, d) - geometry(c, d);
+                for (int a = 0; a < 3; a++) {
+                    m[a] += remote(q, h + a);
+                    for (int b = 0; b < 3; b++) {
+                        m[3 + 3 * a + b] += remote(q, h + 3 + 3 * a + b) + remote(q, h + a) * delta[b];
+                    }
+                }
+            }
+            for (int n = 0; n < moment_size; n++) moments(c, n) = m[n];
+        });
+    }
+
+    /* Velocity induced at a point r from the center of a cell by the cell's
+     * sources, using the first two terms of the Taylor expansion of the BR
+     * kernel about the center:
+     *   u = (Omega x r - sum omega x delta) / |r|^3 + 3 (D r) x r / |r|^5 */
+    template <class MomentView>
+    static KOKKOS_INLINE_FUNCTION
+    void cellVelocity(double out[3], MomentView moments, int c, double r[3], double epsilon)
+    {
+        double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + epsilon;
+        double rinv = 1.0 / sqrt(r2);
+        double rinv3 = rinv * rinv * rinv;
+        double rinv5 = rinv3 * rinv * rinv;
+
+        double omega[3], Dr[3], anti[3], u1[3], u2[3];
+        for (int a = 0; a < 3; a++) {
+            omega[a] = moments(c, a);
+            Dr[a] = 0.0;
+            for (int b = 0; b < 3; b++) {
+                Dr[a] += moments(c, 3 + 3 * a + b) * r[b];
+            }
+        }
+        // sum of omega x delta is the antisymmetric part of D
+        anti[0] = moments(c, 3 + 5) - moments(c, 3 + 7);
+        anti[1] = moments(c, 3 + 6) - moments(c, 3 + 2);
+        anti[2] = moments(c, 3 + 1) - moments(c, 3 + 3);
+
+        Operators::cross(u1, omega, r);
+        Operators::cross(u2, Dr, r);
+        for (int d = 0; d < 3; d++) {
+            out[d] = (u1[d] - anti[d]) * rinv3 + 3.0 * u2[d] * rinv5;
+        }
+    }
+
+    /* Directly compute the velocities using the treecode */
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        double start = MPI_Wtime();
+        Kokkos::Profiling::pushRegion("Treecode BR Build");
+        _tree.update(z, w);
+        computeMoments(_tree.local(), _moments);
+        _tree.exchange(_moments, moment_size, _theta);
+        computeMoments(_tree.essential(), _moments);
+        Kokkos::Profiling::popRegion();
+        double built = MPI_Wtime();
+
+        auto local_space = _pm.mesh().localGrid()->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+
+        auto & tree = _tree.essential();
+        auto cells = tree.geometry;
+        auto links = tree.links;
+        auto sources = tree.sources;
+        auto remote = tree.remote;
+        auto remote_moments = Kokkos::subview(remote, Kokkos::ALL(),
+            Kokkos::make_pair(int(tree_type::remote_header), int(tree_type::remote_header) + moment_size));
+        auto moments = _moments;
+        double epsilon = _epsilon;
+        double theta2 = _theta * _theta;
+
+        /* Each thread owns one point, so it can store its velocity directly.
+         * The periodic images we need are already in the essential tree. */
+        Kokkos::Profiling::pushRegion("Treecode BR Evaluate");
+        Kokkos::parallel_for("Treecode BR Traversal",
+            Cabana::Grid::createExecutionPolicy(local_space, ExecutionSpace()),
+            KOKKOS_LAMBDA(int i, int j) {
+            double brsum[3] = {0.0, 0.0, 0.0};
+            double zi[3] = {z(i, j, 0), z(i, j, 1), z(i, j, 2)};
+
+            int stack[tree_type::stack_size];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                int c = stack[--top];
+                double r[3], dist2 = 0.0, radius = cells(c, 3);
+                for (int d = 0; d < 3; d++) {
+                    r[d] = zi[d] - cells(c, d);
+                    dist2 += r[d] * r[d];
+                }
+
+                if (radius * radius < theta2 * dist2) {
+                    // Well separated: use the cell expansion
+                    double u[3];
+                    cellVelocity(u, moments, c, r, epsilon);
+                    for (int d = 0; d < 3; d++) brsum[d] += u[d];
+                } else if (links(c, tree_type::LINK_NCHILD) == 0) {
+                    // Leaf too close to approximate: sum its sources directly
+                    double offset[3] = {0.0, 0.0, 0.0};
+                    for (int s = links(c, tree_type::LINK_BEGIN); s < links(c, tree_type::LINK_END); s++) {
+                        double zs[3], omega[3], br[3];
+                        for (int d = 0; d < 3; d++) {
+                            zs[d] = sources(s, d);
+                            omega[d] = sources(s, d + 3);
+                        }
+                        Operators::BR(br, zi, zs, omega, epsilon, offset);
+                        for (int d = 0; d < 3; d++) brsum[d] += br[d];
+                    }
+
+                    /* The sender only sent these as expansions because they
+                     * are well separated from all of our points */
+                    for (int q = links(c, tree_type::LINK_REMOTE_BEGIN); q < links(c, tree_type::LINK_REMOTE_END); q++) {
+                        double rq[3], u[3];
+                        for (int d = 0; d < 3; d++) rq[d] = zi[d] - remote(q, d);
+                        cellVelocity(u, remote_moments, q, rq, epsilon);
+                        for (int d = 0; d < 3; d++) brsum[d] += u[d];
+                    }
+                } else {
+                    int first = links(c, tree_type::LINK_CHILD);
+                    for (int k = 0; k < links(c, tree_type::LINK_NCHILD); k++) {
+                        stack[top++] = first + k;
+                    }
+                }
+            }
+
+            for (int d = 0; d < 3; d++) {
+                zdot(i, j, d) = brsum[d];
+            }
+        });
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double evaluated = MPI_Wtime();
+
+        _build_time += built - start;
+        _evaluate_time += evaluated - built;
+        _samples++;
+    }
+
+    /* Print the time spent building and walking the tree, taking the
+     * maximum across processes */
+    void printTimings(std::ostream & out) const override
+    {
+        if (_samples == 0) return;
+
+        double local[2] = {_build_time, _evaluate_time}, global[2];
+        MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_MAX, 0, _comm);
+        if (_rank != 0) return;
+
+        out << "===== Treecode BR Timings (max over ranks) =====\n"
+            << "Build: " << global[0] << " s, evaluate " << global[1] << " s over "
+            << _samples << " calls (theta " << _theta << ", leaf size "
+            << _leaf_size << ")\n"
+            << "Local tree: " << _tree.numBuilds() << " builds, "
+            << _tree.numRefits() << " refits\n"
+            << "================================================\n";
+    }
+
+  private:
+    const pm_type & _pm;
+    double _epsilon;
+    double _theta;
+    int _leaf_size;
+    MPI_Comm _comm;
+    int _rank;
+
+    /* Tree and the expansions of its current essential tree cells. The
+     * essential tree is rebuilt every time the velocity is computed, and
+     * the local tree is refit to the interface when it can be. */
+    mutable tree_type _tree;
+    mutable moment_view _moments;
+
+    mutable double _build_time = 0.0, _evaluate_time = 0.0;
+    mutable int _samples = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_TREECODEBRSOLVER_HPP
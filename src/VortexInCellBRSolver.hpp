@@ -0,0 +1,289 @@
+/****************************************************************************
+ * Copyright (c) 2021, 2022 by the Beatnik authors                          *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the Beatnik benchmark. Beatnik is                   *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+/**
+ * @file VortexInCellBRSolver.hpp
+ *
+ * @section DESCRIPTION
+ * Class that computes the interface velocity with the vortex-in-cell
+ * method, coupling the surface mesh to a spatial mesh. The interface
+ * vorticity is deposited on a 3D spatial mesh, the vector Poisson problem
+ * -laplacian psi = 4 pi omega for the stream function is solved with
+ * distributed FFTs, the velocity u = curl psi is computed by central
+ * differences on the mesh, and it is interpolated back to the interface.
+ * The mesh spacing plays the role of the BR desingularization, so epsilon
+ * is not used. Along dimensions in which the interface is not periodic the
+ * mesh is padded to keep the periodic images of the FFT away, and on a
+ * periodic interface the shear a net sheet strength gives across the
+ * padding is added back to the velocity.
+ */
+
+#ifndef BEATNIK_VORTEXINCELLBRSOLVER_HPP
+#define BEATNIK_VORTEXINCELLBRSOLVER_HPP
+
+// Include Statements
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+#include <BRSolverBase.hpp>
+#include <BoundaryCondition.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <SolverParams.hpp>
+#include <SpatialMesh.hpp>
+
+namespace Beatnik
+{
+
+/**
+ * The VortexInCellBRSolver Class
+ * @class VortexInCellBRSolver
+ * @brief Computes the interface velocity by solving for the stream function
+ * of the interface vorticity on a spatial mesh
+ *
+ * The BR desingularization epsilon passed to the constructor is ignored;
+ * the smoothing comes from the cloud-in-cell deposition and the spatial
+ * mesh spacing (SolverParams::br_mesh_spacing) instead.
+ **/
+template <class ExecutionSpace, class MemorySpace>
+class VortexInCellBRSolver : public BRSolverBase<ExecutionSpace, MemorySpace>
+{
+  public:
+    using exec_space = ExecutionSpace;
+    using memory_space = MemorySpace;
+    using pm_type = ProblemManager<ExecutionSpace, MemorySpace>;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    using spatial_mesh_type = SpatialMesh<ExecutionSpace, MemorySpace>;
+    using particle_type = typename spatial_mesh_type::particle_type;
+    using mesh_type = typename spatial_mesh_type::mesh_type;
+    using mesh_array_type = Cabana::Grid::Array<double, Cabana::Grid::Node, mesh_type, MemorySpace>;
+    using halo_type = Cabana::Grid::Halo<MemorySpace>;
+    using fft_type = Cabana::Grid::Experimental::HeffteFastFourierTransform<Cabana::Grid::Node,
+                         mesh_type, double, memory_space, exec_space,
+                         Cabana::Grid::Experimental::Impl::FFTBackendDefault>;
+
+    VortexInCellBRSolver( const pm_type & pm, const BoundaryCondition &bc,
+                          [[maybe_unused]] const double epsilon,
+                          const double dx, const double dy,
+                          const SolverParams & params = SolverParams() )
+        : _spatial( pm, bc, dx, dy, params.br_mesh_spacing, 2, true )
+        , _particles( "VIC BR particles" )
+    {
+        if (params.br_mesh_spacing <= 0.0) {
+            throw std::invalid_argument("Invalid vortex-in-cell mesh spacing");
+        }
+
+        /* Vorticity and then stream function on the mesh nodes, the mesh
+         * velocity, and the complex (real, imaginary) pair of each
+         * component of the stream function that the FFTs work on */
+        auto local_grid = _spatial.localGrid();
+        auto vector_layout = Cabana::Grid::createArrayLayout(local_grid, 3, Cabana::Grid::Node());
+        auto complex_layout = Cabana::Grid::createArrayLayout(local_grid, 2, Cabana::Grid::Node());
+        _stream = Cabana::Grid::createArray<double, memory_space>("VIC stream function", vector_layout);
+        _velocity = Cabana::Grid::createArray<double, memory_space>("VIC velocity", vector_layout);
+        _stream_halo = Cabana::Grid::createHalo(Cabana::Grid::NodeHaloPattern<3>(), 2, *_stream);
+        _velocity_halo = Cabana::Grid::createHalo(Cabana::Grid::NodeHaloPattern<3>(), 2, *_velocity);
+        for (int d = 0; d < 3; d++) {
+            _spectral[d] = Cabana::Grid::createArray<double, memory_space>("VIC spectral", complex_layout);
+        }
+
+        Cabana::Grid::Experimental::FastFourierTransformParams fft_params;
+        fft_params.setAllToAll(true);
+        fft_params.setPencils(true);
+        fft_params.setReorder(false);
+        _fft = Cabana::Grid::Experimental::createHeffteFastFourierTransform<double, memory_space>(*complex_layout, fft_params);
+    }
+
+    /* Deposit the vorticity of the particles on the mesh with cloud-in-cell
+     * weights */
+    void spreadVorticity() const
+    {
+        auto x = Cabana::slice<spatial_mesh_type::Position>(_particles);
+        auto omega = Cabana::slice<spatial_mesh_type::Vorticity>(_particles);
+        Cabana::Grid::ArrayOp::assign(*_stream, 0.0, Cabana::Grid::Ghost());
+        Cabana::Grid::p2g(Cabana::Grid::createVectorValueP2G(omega, 1.0), x, _particles.size(),
+                          Cabana::Grid::Spline<1>(), *_stream_halo, *_stream);
+    }
+
+    /* Replace the vorticity on the mesh by the stream function. The
+     * Poisson problem is solved with the symbol of the 7-point Laplacian,
+     * so that discrete operator is inverted exactly. */
+    void solveStreamFunction() const
+    {
+        auto local_grid = _spatial.localGrid();
+        auto & global_grid = local_grid->globalGrid();
+        auto own_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+
+        auto stream = _stream->view();
+        auto s0 = _spectral[0]->view();
+        auto s1 = _spectral[1]->view();
+        auto s2 = _spectral[2]->view();
+        Kokkos::parallel_for("VIC BR Build FFT Arrays",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            s0(i, j, k, 0) = stream(i, j, k, 0);
+            s1(i, j, k, 0) = stream(i, j, k, 1);
+            s2(i, j, k, 0) = stream(i, j, k, 2);
+            s0(i, j, k, 1) = 0.0;
+            s1(i, j, k, 1) = 0.0;
+            s2(i, j, k, 1) = 0.0;
+        });
+        for (int d = 0; d < 3; d++) {
+            _fft->forward(*_spectral[d], Cabana::Grid::Experimental::FFTScaleNone());
+        }
+
+        /* The deposited values are vorticity times cell volume */
+        Kokkos::Array<int, 3> offset, num_node;
+        Kokkos::Array<double, 3> kscale, h;
+        double volume = 1.0;
+        for (int d = 0; d < 3; d++) {
+            offset[d] = global_grid.globalOffset(d) - own_nodes.min(d);
+            num_node[d] = global_grid.globalNumEntity(Cabana::Grid::Node(), d);
+            kscale[d] = 2.0 * Kokkos::numbers::pi_v<double> / num_node[d];
+            h[d] = _spatial.cellSize()[d];
+            volume *= h[d];
+        }
+        Kokkos::parallel_for("VIC BR Poisson Solve",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            int index[3] = {i + offset[0], j + offset[1], k + offset[2]};
+            double k2 = 0.0;
+            for (int d = 0; d < 3; d++) {
+                double kh = 2.0 * Kokkos::sin(0.5 * index[d] * kscale[d]) / h[d];
+                k2 += kh * kh;
+            }
+            double green = (k2 > 0.0) ? 4.0 * Kokkos::numbers::pi_v<double> / (k2 * volume) : 0.0;
+            for (int c = 0; c < 2; c++) {
+                s0(i, j, k, c) *= green;
+                s1(i, j, k, c) *= green;
+                s2(i, j, k, c) *= green;
+            }
+        });
+        for (int d = 0; d < 3; d++) {
+            _fft->reverse(*_spectral[d], Cabana::Grid::Experimental::FFTScaleFull());
+        }
+
+        Kokkos::parallel_for("VIC BR Store Stream Function",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            stream(i, j, k, 0) = s0(i, j, k, 0);
+            stream(i, j, k, 1) = s1(i, j, k, 0);
+            stream(i, j, k, 2) = s2(i, j, k, 0);
+        });
+    }
+
+    /* Take the curl of the stream function on the mesh and interpolate it
+     * to the particles with the weights used to deposit the vorticity. The
+     * kx = ky = 0 modes were solved as periodic in z, so add what that
+     * leaves out of the velocity of a net sheet strength. */
+    void interpolateVelocity() const
+    {
+        auto local_grid = _spatial.localGrid();
+        auto own_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        _stream_halo->gather(ExecutionSpace(), *_stream);
+
+        auto stream = _stream->view();
+        auto velocity = _velocity->view();
+        Kokkos::Array<double, 3> h = _spatial.cellSize();
+        Kokkos::parallel_for("VIC BR Curl",
+            Cabana::Grid::createExecutionPolicy(own_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j, const int k) {
+            /* grad(d, c) = d psi_c / d x_d */
+            double grad[3][3];
+            for (int c = 0; c < 3; c++) {
+                grad[0][c] = (stream(i + 1, j, k, c) - stream(i - 1, j, k, c)) / (2.0 * h[0]);
+                grad[1][c] = (stream(i, j + 1, k, c) - stream(i, j - 1, k, c)) / (2.0 * h[1]);
+                grad[2][c] = (stream(i, j, k + 1, c) - stream(i, j, k - 1, c)) / (2.0 * h[2]);
+            }
+            velocity(i, j, k, 0) = grad[1][2] - grad[2][1];
+            velocity(i, j, k, 1) = grad[2][0] - grad[0][2];
+            velocity(i, j, k, 2) = grad[0][1] - grad[1][0];
+        });
+
+        auto x = Cabana::slice<spatial_mesh_type::Position>(_particles);
+        auto u = Cabana::slice<spatial_mesh_type::Velocity>(_particles);
+        Cabana::Grid::g2p(*_velocity, *_velocity_halo, x, _particles.size(), Cabana::Grid::Spline<1>(),
+                          Cabana::Grid::createVectorValueG2P(u, 1.0));
+        _spatial.correctSheetStrength(_particles, _particles.size());
+    }
+
+    /* Compute the interface velocities with the vortex-in-cell method */
+    void computeInterfaceVelocity(node_view zdot, node_view z, node_view w) const override
+    {
+        double start = MPI_Wtime();
+        Kokkos::Profiling::pushRegion("VIC BR Distribute");
+        _spatial.createParticles(z, w, _particles);
+        _spatial.checkExtent(_particles);
+        _spatial.migrate(_particles);
+        Kokkos::Profiling::popRegion();
+        double distributed = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("VIC BR Mesh Solve");
+        spreadVorticity();
+        solveStreamFunction();
+        interpolateVelocity();
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double solved = MPI_Wtime();
+
+        Kokkos::Profiling::pushRegion("VIC BR Return");
+        _spatial.returnVelocities(_particles, _particles.size(), zdot);
+        ExecutionSpace().fence();
+        Kokkos::Profiling::popRegion();
+        double returned = MPI_Wtime();
+
+        _comm_time += (distributed - start) + (returned - solved);
+        _solve_time += solved - distributed;
+        _samples++;
+    }
+
+    /* Print the time spent moving particles and on the mesh, taking the
+     * maximum across processes */
+    void printTimings(std::ostream & out) const override
+    {
+        if (_samples == 0) return;
+
+        double local[2] = {_comm_time, _solve_time}, global[2];
+        MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_MAX, 0, _spatial.comm());
+        if (_spatial.rank() != 0) return;
+
+        auto & global_grid = _spatial.localGrid()->globalGrid();
+        out << "===== Vortex-in-Cell BR Timings (max over ranks) =====\n"
+            << "Communication: " << global[0] << " s, mesh solve " << global[1]
+            << " s over " << _samples << " calls ("
+            << global_grid.globalNumEntity(Cabana::Grid::Cell(), 0) << "x"
+            << global_grid.globalNumEntity(Cabana::Grid::Cell(), 1) << "x"
+            << global_grid.globalNumEntity(Cabana::Grid::Cell(), 2) << " mesh)\n"
+            << "======================================================\n";
+    }
+
+  private:
+    spatial_mesh_type _spatial;
+    mutable particle_type _particles;
+
+    std::shared_ptr<mesh_array_type> _stream, _velocity;
+    std::shared_ptr<halo_type> _stream_halo, _velocity_halo;
+    std::shared_ptr<mesh_array_type> _spectral[3];
+    std::shared_ptr<fft_type> _fft;
+
+    mutable double _comm_time = 0.0, _solve_time = 0.0;
+    mutable int _samples = 0;
+};
+
+} // end namespace Beatnik
+
+#endif // BEATNIK_VORTEXINCELLBRSOLVER_HPP
@@ -31,12 +31,20 @@
 #include <Cabana_Grid.hpp>
 #include <Kokkos_Core.hpp>
 
+#include <fstream>
+#include <iostream>
+#include <limits>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <mpi.h>
 
 #include <Mesh.hpp>
 
 #include <BoundaryCondition.hpp>
 #include <Operators.hpp>
+#include <SolverParams.hpp>
 
 namespace Beatnik
 {
@@ -77,10 +85,47 @@ class ZModel
 
     using halo_type = Cabana::Grid::Halo<MemorySpace>;
 
+    /* Which far-field methods the model order uses: the low and medium 
+     * order models use the reisz transform and the medium and high order
+     * models use the Birkhoff-Rott solver */
+    static constexpr bool needs_reisz = !std::is_same_v<MethodOrder, Order::High>;
+    static constexpr bool needs_br = !std::is_same_v<MethodOrder, Order::Low>;
+
+    /* Runge-Kutta stage update fused into the final kernels of the 
+     * derivative computation: instead of returning the derivatives, write
+     * u_out = a * u_start + b * u + c * du_dt, where u is the state the 
+     * derivatives are computed at and c includes the timestep. Either
+     * output may be the state being differentiated. The vorticity is 
+     * differenced in the kernel that computes its derivative, so updating
+     * it in place takes one more pass, which stages the derivative in the
+     * interface velocity array. */
+    struct StageUpdate
+    {
+        double a, b, c;
+        node_view z_start, w_start;
+        node_view z_out, w_out;
+    };
+
+    /* The surface geometry is only computed ahead of the velocity phase,
+     * on its own execution space instance, where that instance can run
+     * alongside the default one. A host backend partitioned into a single
+     * instance gains nothing from it, so there the velocity kernel computes
+     * the geometry itself and the geometry array isn't allocated. */
+    static constexpr bool overlap_geometry = !Kokkos::SpaceAccessibility<
+        Kokkos::HostSpace, typename ExecutionSpace::memory_space>::accessible;
+
+    /* Number of surface geometry values stored per node: h11, h12, h22 and
+     * the unit normal. det_h is cheaper to recompute than to store. */
+    static constexpr int geometry_size = 6;
+
+    /* Forward/reverse transform pairs timed per HeFFTe configuration */
+    static constexpr int fft_tune_trials = 5;
+
     ZModel( const pm_type & pm, const BoundaryCondition &bc,
             const BRSolver *br, /* pointer because could be null */
             const double dx, const double dy, 
-            const double A, const double g, const double mu)
+            const double A, const double g, const double mu,
+            const SolverParams & params = SolverParams() )
         : _pm( pm )
         , _bc( bc )
         , _br( br )
@@ -89,6 +134,8 @@ class ZModel
         , _A( A )
         , _g( g )
         , _mu( mu )
+        , _implicit_viscosity( params.implicit_viscosity )
+        , _geometry_space( Kokkos::Experimental::partition_space(ExecutionSpace(), 1)[0] )
     {
         // Need the node triple layout for storing vector normals and the 
         // node double layout for storing x and y surface derivative
@@ -110,25 +157,133 @@ class ZModel
         _v_halo = Cabana::Grid::createHalo( Cabana::Grid::FaceHaloPattern<2>(),
                             halo_depth, *_V );
 
+        /* Surface geometry at each owned node, which only depends on the
+         * interface position, handed from the geometry kernel to the
+         * velocity kernel when they run on different instances */
+        if constexpr ( overlap_geometry ) {
+            auto node_geometry_layout =
+                Cabana::Grid::createArrayLayout( _pm.mesh().localGrid(), geometry_size, Cabana::Grid::Node() );
+            _geometry = Cabana::Grid::createArray<double, memory_space>(
+                "surface geometry", node_geometry_layout );
+        }
+
         /* Storage for the reisz transform of the vorticity. In the low and 
          * medium order models, it is used to calculate the vorticity 
          * derivative. In the low order model, it is also projected onto the 
-         * surface normal to compute the interface velocity.  
-         * XXX Make this conditional on the model we run. */
-        _reisz = Cabana::Grid::createArray<double, memory_space>( "reisz", node_double_layout );
-        Cabana::Grid::ArrayOp::assign( *_reisz, 0.0, Cabana::Grid::Ghost() );
-
-        /* If we're not the hgh order model, initialize the FFT solver and 
-         * the working space it will need. 
-         * XXX figure out how to make this conditional on model order. */
-        Cabana::Grid::Experimental::FastFourierTransformParams params;
-        _C1 = Cabana::Grid::createArray<double, memory_space>("C1", node_double_layout);
-        _C2 = Cabana::Grid::createArray<double, memory_space>("C2", node_double_layout);
-
-        params.setAllToAll(true);
-        params.setPencils(true);
-        params.setReorder(false);
-        _fft = Cabana::Grid::Experimental::createHeffteFastFourierTransform<double, memory_space>(*node_double_layout, params);
+         * surface normal to compute the interface velocity. The high order
+         * model never computes it, so it doesn't need it or the FFT solver
+         * and working space used to compute it unless it integrates the 
+         * artificial viscosity spectrally. */
+        if constexpr ( needs_reisz ) {
+            _reisz_multipliers = Cabana::Grid::createArray<double, memory_space>( "reisz multipliers", node_double_layout );
+            computeReiszMultipliers();
+        }
+        if ( _implicit_viscosity ) {
+            if ( _bc.boundary_type[0] != PERIODIC || _bc.boundary_type[1] != PERIODIC ) {
+                throw std::invalid_argument( "Implicit viscosity requires periodic boundaries" );
+            }
+            _viscosity_symbol = Cabana::Grid::createArray<double, memory_space>( "viscosity symbol", node_scalar_layout );
+            computeViscositySymbol();
+        }
+        if ( needs_reisz || _implicit_viscosity ) {
+            _reisz = Cabana::Grid::createArray<double, memory_space>( "reisz", node_double_layout );
+
+            auto fft_params = chooseFFTParams( *node_double_layout, params );
+            _fft = Cabana::Grid::Experimental::createHeffteFastFourierTransform<double, memory_space>(*node_double_layout, fft_params);
+            Cabana::Grid::ArrayOp::assign( *_reisz, 0.0, Cabana::Grid::Ghost() );
+        }
+    }
+
+    /* Pick the HeFFTe plan options for the reisz transform. By default we 
+     * use all-to-all communication and pencil decompositions without 
+     * reordering. When autotuning, every combination of those options is 
+     * timed on the actual layout (using _reisz as scratch) and the fastest
+     * is kept. If a cache file is given, a choice already recorded there for
+     * the same mesh size and process count is reused instead, and new 
+     * choices are appended to it. */
+    template <class LayoutType>
+    Cabana::Grid::Experimental::FastFourierTransformParams
+    chooseFFTParams( const LayoutType & layout, const SolverParams & params )
+    {
+        Cabana::Grid::Experimental::FastFourierTransformParams fft_params;
+        fft_params.setAllToAll(true);
+        fft_params.setPencils(true);
+        fft_params.setReorder(false);
+        if (!params.fft_autotune) return fft_params;
+
+        auto & global_grid = _pm.mesh().localGrid()->globalGrid();
+        MPI_Comm comm = global_grid.comm();
+        int rank, num_procs;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &num_procs);
+        int nx = global_grid.globalNumEntity(Cabana::Grid::Node(), 0);
+        int ny = global_grid.globalNumEntity(Cabana::Grid::Node(), 1);
+
+        /* Cached, all-to-all, pencils, reorder */
+        int choice[4] = {0, 1, 1, 0};
+        if (rank == 0 && !params.fft_tune_cache.empty()) {
+            std::ifstream in(params.fft_tune_cache);
+            int cache_nx, cache_ny, cache_procs, alltoall, pencils, reorder;
+            while (in >> cache_nx >> cache_ny >> cache_procs >> alltoall >> pencils >> reorder) {
+                if (cache_nx == nx && cache_ny == ny && cache_procs == num_procs) {
+                    choice[0] = 1;
+                    choice[1] = alltoall;
+                    choice[2] = pencils;
+                    choice[3] = reorder;
+                }
+            }
+        }
+        MPI_Bcast(choice, 4, MPI_INT, 0, comm);
+
+        if (!choice[0]) {
+            double best = std::numeric_limits<double>::max();
+            for (int config = 0; config < 8; config++) {
+                Cabana::Grid::Experimental::FastFourierTransformParams candidate;
+                candidate.setAllToAll((config & 1) != 0);
+                candidate.setPencils((config & 2) != 0);
+                candidate.setReorder((config & 4) != 0);
+                auto fft = Cabana::Grid::Experimental::createHeffteFastFourierTransform<double, memory_space>(layout, candidate);
+
+                /* One untimed pair of transforms to warm up the plan */
+                Cabana::Grid::ArrayOp::assign( *_reisz, 1.0, Cabana::Grid::Own() );
+                fft->forward(*_reisz, Cabana::Grid::Experimental::FFTScaleNone());
+                fft->reverse(*_reisz, Cabana::Grid::Experimental::FFTScaleFull());
+                ExecutionSpace().fence();
+                MPI_Barrier(comm);
+
+                double start = MPI_Wtime();
+                for (int trial = 0; trial < fft_tune_trials; trial++) {
+                    fft->forward(*_reisz, Cabana::Grid::Experimental::FFTScaleNone());
+                    fft->reverse(*_reisz, Cabana::Grid::Experimental::FFTScaleFull());
+                }
+                ExecutionSpace().fence();
+                double elapsed = MPI_Wtime() - start;
+                MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, comm);
+                if (elapsed < best) {
+                    best = elapsed;
+                    choice[1] = config & 1;
+                    choice[2] = (config >> 1) & 1;
+                    choice[3] = (config >> 2) & 1;
+                }
+            }
+
+            if (rank == 0 && !params.fft_tune_cache.empty()) {
+                std::ofstream out(params.fft_tune_cache, std::ios::app);
+                out << nx << " " << ny << " " << num_procs << " " << choice[1] << " "
+                    << choice[2] << " " << choice[3] << "\n";
+            }
+        }
+
+        if (rank == 0) {
+            std::cout << "FFT autotuning (" << (choice[0] ? "cached" : "timed") << "): "
+                      << (choice[1] ? "all-to-all" : "point-to-point") << ", "
+                      << (choice[2] ? "pencils" : "slabs") << ", "
+                      << (choice[3] ? "reorder" : "no reorder") << "\n";
+        }
+        fft_params.setAllToAll(choice[1] != 0);
+        fft_params.setPencils(choice[2] != 0);
+        fft_params.setReorder(choice[3] != 0);
+        return fft_params;
     }
 
     double computeMinTimestep(double atwood, double g)
@@ -183,43 +338,20 @@ class ZModel
         }
     }
 
-    template <class VorticityView>
-    void computeReiszTransform(VorticityView w) const
+    /* The reisz transform multiplies the FFT of the vorticity by 
+     * M = k / |k| at every node. The mesh never changes, so compute M once. */
+    void computeReiszMultipliers()
     {
-        /* Construct the temporary arrays C1 and C2 */
         auto local_grid = _pm.mesh().localGrid();
         auto & global_grid = local_grid->globalGrid();
         auto local_mesh = Cabana::Grid::createLocalMesh<device_type>( *local_grid );
         auto local_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
-
-        /* Get the views we'll be computing with in parallel loops */
-        auto C1 = _C1->view();
-        auto C2 = _C2->view();
-        auto reisz = _reisz->view();
-
-        /* First put w into the real parts of C1 and C2 (and zero out
-         * any imaginary parts left from previous runs!) */
-        Kokkos::parallel_for("Build FFT Arrays", 
-                     Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()), 
-                     KOKKOS_LAMBDA(const int i, const int j) {
-            C1(i, j, 0) = w(i, j, 0);
-            C1(i, j, 1) = 0;
-            C2(i, j, 0) = w(i, j, 1);
-            C2(i, j, 1) = 0;
-        });
-
-        /* Do we need to halo C1 and C2 now? We shouldn't, since the FFT should take
-         * care of that. */
-
-        /* Now do the FFTs of vorticity */
-        _fft->forward(*_C1, Cabana::Grid::Experimental::FFTScaleNone());
-        _fft->forward(*_C2, Cabana::Grid::Experimental::FFTScaleNone());
+        auto M = _reisz_multipliers->view();
 
         int nx = global_grid.globalNumEntity(Cabana::Grid::Node(), 0);
         int ny = global_grid.globalNumEntity(Cabana::Grid::Node(), 1);
 
-        /* Now construct reisz from the weighted sum of those FFTs to take the inverse FFT. */
-        parallel_for("Combine FFTs", 
+        parallel_for("Reisz Multipliers", 
                      Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()), 
                      KOKKOS_LAMBDA(const int i, const int j) {
             int indicies[2] = {i, j};
@@ -230,23 +362,155 @@ class ZModel
             double k2 = reiszWeight(location[1], ny);
 
             if ((k1 != 0) || (k2 != 0)) {
-                /* real part = -i * M1 * imag(C1) + -i * M2 * imag(C2)
-                 *           = M1 * imag(C1) + M2 * imag(C2)
-                 * imag part = -i * M1 * real(C1) - i * M2 * real(C2)
-                 *           = -M1 * real(C1) - M2 * real(C2)
-                 */
                 double len = sqrt(k1 * k1 + k2 * k2);
-                double M1 = k1 / len;
-                double M2 = k2 / len;
-
-                reisz(i, j, 0) = M1 * C1(i, j, 1) + M2 * C2(i, j, 1);
-                reisz(i, j, 1) = -M1 * C1(i, j, 0) - M2 * C2(i, j, 0);
+                M(i, j, 0) = k1 / len;
+                M(i, j, 1) = k2 / len;
             } else {
-                reisz(i, j, 0) = 0.0; 
-                reisz(i, j, 1) = 0.0;
+                M(i, j, 0) = 0.0;
+                M(i, j, 1) = 0.0;
             }
         });
+    }
+
+    /* Fourier symbol of the 9-point laplace operator used for the artificial
+     * viscosity, so that the implicit and explicit treatments of the 
+     * viscosity agree on the mesh. The FFT stores the mode with global index
+     * g at global node g, so the symbol is computed from the global index of
+     * each owned node. */
+    void computeViscositySymbol()
+    {
+        auto local_grid = _pm.mesh().localGrid();
+        auto & global_grid = local_grid->globalGrid();
+        auto local_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto L = _viscosity_symbol->view();
+        auto L2G = Cabana::Grid::IndexConversion::L2G<mesh_type, Node>( *local_grid );
+
+        int nx = global_grid.globalNumEntity(Cabana::Grid::Node(), 0);
+        int ny = global_grid.globalNumEntity(Cabana::Grid::Node(), 1);
+        double dx = _dx, dy = _dy;
+
+        parallel_for("Viscosity Symbol", 
+                     Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()), 
+                     KOKKOS_LAMBDA(const int i, const int j) {
+            int li[2] = {i, j};
+            int gi[2] = {0, 0};
+            L2G(li, gi);
+            L(i, j, 0) = Operators::laplaceSymbol(gi[0], nx, gi[1], ny, dx, dy);
+        });
+    }
+
+    /* Integrate the artificial viscosity term of the vorticity equation, 
+     * dw/dt = mu * laplace(w), over delta_t exactly in Fourier space, which
+     * is stable for any timestep. The two vorticity components are packed 
+     * into one complex field, and since the decay factor is real and even 
+     * in k they come back out of the real and imaginary parts unmixed. */
+    void applyImplicitViscosity( const double delta_t ) const
+    {
+        auto local_grid = _pm.mesh().localGrid();
+        auto local_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+
+        auto w = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+        auto work = _reisz->view();
+        auto L = _viscosity_symbol->view();
+        double mu = _mu;
+
+        Kokkos::parallel_for("Viscosity Pack",
+            Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j) {
+            work(i, j, 0) = w(i, j, 0);
+            work(i, j, 1) = w(i, j, 1);
+        });
+
+        _fft->forward(*_reisz, Cabana::Grid::Experimental::FFTScaleNone());
+
+        Kokkos::parallel_for("Viscosity Decay",
+            Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j) {
+            double decay = exp(mu * delta_t * L(i, j, 0));
+            work(i, j, 0) *= decay;
+            work(i, j, 1) *= decay;
+        });
+
+        _fft->reverse(*_reisz, Cabana::Grid::Experimental::FFTScaleFull());
+
+        Kokkos::parallel_for("Viscosity Unpack",
+            Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()),
+            KOKKOS_LAMBDA(const int i, const int j) {
+            w(i, j, 0) = work(i, j, 0);
+            w(i, j, 1) = work(i, j, 1);
+        });
+    }
+
+    bool implicitViscosity() const
+    {
+        return _implicit_viscosity;
+    }
+
+    /* Compute the reisz transform of the vorticity in place in _reisz, which
+     * is the only FFT workspace. The forward transform, the multiplication
+     * by the reisz multipliers, and the reverse transform are separate 
+     * phases so that callers can do other work in between them. */
+    template <class VorticityView>
+    void computeReiszTransform(VorticityView w) const
+    {
+        reiszForward(w);
+        reiszMultiply();
+        reiszReverse();
+    }
+
+    template <class VorticityView>
+    void reiszForward(VorticityView w) const
+    {
+        auto local_grid = _pm.mesh().localGrid();
+        auto local_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto reisz = _reisz->view();
+
+        /* Both vorticity components are real, so pack them into a single
+         * complex field w0 + i * w1 and transform it once */
+        Kokkos::parallel_for("Build FFT Arrays", 
+                     Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()), 
+                     KOKKOS_LAMBDA(const int i, const int j) {
+            reisz(i, j, 0) = w(i, j, 0);
+            reisz(i, j, 1) = w(i, j, 1);
+        });
+
+        /* Now do the FFT of vorticity */
+        _fft->forward(*_reisz, Cabana::Grid::Experimental::FFTScaleNone());
+    }
 
+    void reiszMultiply() const
+    {
+        auto local_grid = _pm.mesh().localGrid();
+        auto local_nodes = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+        auto reisz = _reisz->view();
+        auto M = _reisz_multipliers->view();
+
+        /* Now multiply the packed FFT C to take the inverse FFT. With W0 and
+         * W1 the transforms of the two components, we want the real part of
+         * the inverse of -i * (M1 * W0 + M2 * W1). M1 and M2 are real and
+         * odd in k, so -i * M * W is Hermitian for real w and its inverse is
+         * real. Applying -i * M1 to C = W0 + i * W1 gives t1(w0) + i * t1(w1)
+         * after the inverse, and -i * M2 gives t2(w0) + i * t2(w1), so the
+         * inverse of
+         *     -i * M1 * C - i * (-i * M2 * C) = -(M2 + i * M1) * C
+         * has real part t1(w0) + t2(w1), the transform we want, without
+         * separating W0 and W1 (which needs C at -k, often on another
+         * process). Its imaginary part is t1(w1) - t2(w0), which isn't used. */
+        parallel_for("Combine FFTs", 
+                     Cabana::Grid::createExecutionPolicy(local_nodes, ExecutionSpace()), 
+                     KOKKOS_LAMBDA(const int i, const int j) {
+            /* real part = M1 * imag(C) - M2 * real(C)
+             * imag part = -M1 * real(C) - M2 * imag(C)
+             */
+            double M1 = M(i, j, 0), M2 = M(i, j, 1);
+            double re = reisz(i, j, 0), im = reisz(i, j, 1);
+            reisz(i, j, 0) = M1 * im - M2 * re;
+            reisz(i, j, 1) = -M1 * re - M2 * im;
+        });
+    }
+
+    void reiszReverse() const
+    {
         /* We then do the reverse transform to finish the reisz transform,
          * which is used later to calculate final interface velocity */
         _fft->reverse(*_reisz, Cabana::Grid::Experimental::FFTScaleFull());
@@ -263,11 +527,19 @@ class ZModel
 
     /* For medium order, we calculate the fourier velocity that we later 
      * normalize for vorticity calculations and directly compute the 
-     * interface velocity (zdot) using a far field method. */
+     * interface velocity (zdot) using a far field method. The two are 
+     * independent, so the far field solve is started first and the reisz
+     * transform runs while its kernels and messages are in flight, with the
+     * far field solve advanced between the phases of the transform. */
     void prepareVelocities(Order::Medium, node_view zdot, node_view z, node_view w) const
     {
-        computeReiszTransform(w);
-        _br->computeInterfaceVelocity(zdot, z, w);
+        _br->computeInterfaceVelocityBegin(zdot, z, w);
+        reiszForward(w);
+        _br->computeInterfaceVelocityProgress();
+        reiszMultiply();
+        _br->computeInterfaceVelocityProgress();
+        reiszReverse();
+        _br->computeInterfaceVelocityFinish();
     }
 
     /* For high order, we just directly compute the interface velocity (zdot)
@@ -311,6 +583,28 @@ class ZModel
         zndot = sqrt(Operators::dot(interface_velocity, interface_velocity));
     }
  
+    // Surface metric h11, h12, h22, its determinant and the unit normal at a
+    // node, from fourth-order central differences of the haloed position
+    template <class ViewType>
+    KOKKOS_INLINE_FUNCTION
+    static void surfaceGeometry(ViewType z, int i, int j, double dx, double dy,
+                                double h[3], double &deth, double N[3])
+    {
+        double dx_z[3], dy_z[3];
+        for (int n = 0; n < 3; n++) {
+           dx_z[n] = Operators::Dx(z, i, j, n, dx);
+           dy_z[n] = Operators::Dy(z, i, j, n, dy);
+        }
+
+        h[0] = Operators::dot(dx_z, dx_z);
+        h[1] = Operators::dot(dx_z, dy_z);
+        h[2] = Operators::dot(dy_z, dy_z);
+        deth = h[0]*h[2] - h[1]*h[1];
+
+        Operators::cross(N, dx_z, dy_z);
+        for (int n = 0; n < 3; n++) N[n] /= sqrt(deth);
+    }
+
     // External entry point from the TimeIntegration object that uses the
     // problem manager state.
     void computeDerivatives( node_view zdot, node_view wdot ) const
@@ -330,69 +624,125 @@ class ZModel
 	computeHaloedDerivatives( z.view(), w.view(), zdot, wdot );
     }
 
+    // External entry points from the TimeIntegration object that apply a 
+    // Runge-Kutta stage update in place of returning the derivatives, using 
+    // the problem manager state or the passed-in state. zdot is still needed
+    // as working space for the interface velocity.
+    void computeStage( const StageUpdate & stage, node_view zdot ) const
+    {
+       _pm.gather();
+       auto z_orig = _pm.get( Cabana::Grid::Node(), Field::Position() );
+       auto w_orig = _pm.get( Cabana::Grid::Node(), Field::Vorticity() );
+       computeHaloedDerivatives( z_orig, w_orig, zdot, node_view(), &stage );
+    }
+
+    void computeStage( node_array &z, node_array &w, const StageUpdate & stage,
+                       node_view zdot ) const
+    {
+        _pm.gather( z, w );
+        computeHaloedDerivatives( z.view(), w.view(), zdot, node_view(), &stage );
+    }
+
     // Shared internal entry point from the external points from the
     // TimeIntegration object
     void computeHaloedDerivatives( node_view z_view, node_view w_view,
-                                   node_view zdot, node_view wdot ) const
+                                   node_view zdot, node_view wdot,
+                                   const StageUpdate * stage = nullptr ) const
     {
         // External calls to this object work on Cabana::Grid arrays, but internal
         // methods mostly work on the views, with the entry points responsible
         // for handling the halos.
 	double dx = _dx, dy = _dy;
  
+        auto local_grid = _pm.mesh().localGrid();
+        auto own_node_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
+
+        // Phase 0: The surface geometry only depends on the (already haloed)
+        // interface position, so where it pays, compute it on its own 
+        // execution space instance, where it runs concurrently with phase 1.
+        // Kokkos has no events between instances, so wait on the default
+        // instance, which produced the haloed position in _pm.gather() and
+        // last read the geometry array in the previous call's phase 2.
+        node_view geometry;
+        if constexpr ( overlap_geometry ) {
+            geometry = _geometry->view();
+            ExecutionSpace().fence( "ZModel: haloed position for the geometry" );
+            Kokkos::parallel_for( "Interface Geometry",
+                createExecutionPolicy(own_node_space, _geometry_space),
+                KOKKOS_LAMBDA(int i, int j) {
+                double h[3], deth, N[3];
+                surfaceGeometry(z_view, i, j, dx, dy, h, deth, N);
+                for (int n = 0; n < 3; n++) {
+                    geometry(i, j, n) = h[n];
+                    geometry(i, j, 3 + n) = N[n];
+                }
+            });
+        }
+
         // Phase 1: Globally-dependent bulk synchronous calculations that 
         // namely the reisz transform and/or far-field force solve to calculate
         // interface velocity and velocity normal magnitudes, using the
-        // appropriate method. We do not attempt to overlap this with the 
-        // mostly-local parallel calculations in phase 2
+        // appropriate method. 
         prepareVelocities(MethodOrder(), zdot, z_view, w_view);
+        if constexpr ( overlap_geometry ) _geometry_space.fence();
 
-        auto reisz = _reisz->view();
+        node_view reisz;
+        if constexpr ( needs_reisz ) reisz = _reisz->view();
         double g = _g;
         double A = _A;
 
+        // Stage update coefficients and states, if fused
+        bool fused = (stage != nullptr);
+        double sa = 0.0, sb = 0.0, sc = 0.0;
+        node_view z_start, w_start, z_out, w_out;
+        if (fused) {
+            sa = stage->a; sb = stage->b; sc = stage->c;
+            z_start = stage->z_start; w_start = stage->w_start;
+            z_out = stage->z_out; w_out = stage->w_out;
+        }
+
         // Phase 2: Process the globally-dependent velocity information into 
         // into final interface position derivatives and the information 
         // needed for calculating the vorticity derivative
         auto V_view = _V->view();
 
-        auto local_grid = _pm.mesh().localGrid();
-        auto own_node_space = local_grid->indexSpace(Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local());
         Kokkos::parallel_for( "Interface Velocity",  
             createExecutionPolicy(own_node_space, ExecutionSpace()), 
             KOKKOS_LAMBDA(int i, int j) {
-            //  2.1 Compute Dx and Dy of z and w by fourth-order central differencing. 
-            double dx_z[3], dy_z[3];
-
-            for (int n = 0; n < 3; n++) {
-               dx_z[n] = Operators::Dx(z_view, i, j, n, dx);
-               dy_z[n] = Operators::Dy(z_view, i, j, n, dy);
+            //  2.1 Get the surface geometry, precomputed if it was overlapped
+            double h[3], deth, N[3];
+            if constexpr ( overlap_geometry ) {
+                for (int n = 0; n < 3; n++) {
+                    h[n] = geometry(i, j, n);
+                    N[n] = geometry(i, j, 3 + n);
+                }
+                deth = h[0]*h[2] - h[1]*h[1];
+            } else {
+                surfaceGeometry(z_view, i, j, dx, dy, h, deth, N);
             }
+            double h11 = h[0], h12 = h[1], h22 = h[2];
 
-            //  2.2 Compute h11, h12, h22, and det_h from Dx and Dy
-            double h11 = Operators::dot(dx_z, dx_z);
-            double h12 = Operators::dot(dx_z, dy_z);
-            double h22 = Operators::dot(dy_z, dy_z);
-            double deth = h11*h22 - h12*h12;
-
-            //  2.3 Compute the surface normal as (Dx \cross Dy)/sqrt(deth)
-            double N[3];
-            Operators::cross(N, dx_z, dy_z);
-            for (int n = 0; n < 3; n++)
-		N[n] /= sqrt(deth);
-
-            //  2.4 Compute zdot and zndot as needed using specialized helper functions
+            //  2.2 Compute zdot and zndot as needed using specialized helper functions
             double zndot;
             finalizeVelocity(MethodOrder(), zndot, zdot, i, j, 
                              reisz, N, deth );
 
-            //  2.5 Compute V from zndot and vorticity 
+            //  2.3 Compute V from zndot and vorticity 
 	    double w1 = w_view(i, j, 0); 
             double w2 = w_view(i, j, 1);
 
 	    V_view(i, j, 0) = zndot * zndot 
                          - 0.25*(h22*w1*w1 - 2.0*h12*w1*w2 + h11*w2*w2)/deth 
                          - 2*g*z_view(i, j, 2);
+
+            //  2.4 Apply the position stage update now that nothing else
+            //  needs this point's position
+            if (fused) {
+                for (int n = 0; n < 3; n++) {
+                    z_out(i, j, n) = sa * z_start(i, j, n) + sb * z_view(i, j, n) 
+                                   + sc * zdot(i, j, n);
+                }
+            }
         });
 
         // 3. Phase 3: Halo V and apply boundary condtions on it, then calculate
@@ -404,7 +754,14 @@ class ZModel
         _v_halo->gather( ExecutionSpace(), *_V);
         _bc.applyField( _pm.mesh(), *_V, 1 );
 
-        double mu = _mu;
+        // The viscosity is left to applyImplicitViscosity if it's implicit
+        double mu = _implicit_viscosity ? 0.0 : _mu;
+
+        // Neighbors still have to read the vorticity this kernel would
+        // update in place, so in that case stage the derivative in zdot,
+        // which nothing reads after phase 2, and update it afterwards
+        bool in_place = fused && (w_out.data() == w_view.data());
+        node_view dw_out = in_place ? zdot : wdot;
         Kokkos::parallel_for( "Interface Vorticity",
             createExecutionPolicy(own_node_space, ExecutionSpace()), 
             KOKKOS_LAMBDA(int i, int j) {
@@ -412,10 +769,28 @@ class ZModel
             double dy_v = Operators::Dy(V_view, i, j, 0, dy);
             double lap_w0 = Operators::laplace(w_view, i, j, 0, dx, dy);
             double lap_w1 = Operators::laplace(w_view, i, j, 1, dx, dy);
-            wdot(i, j, 0) = A * dx_v + mu * lap_w0;
-            wdot(i, j, 1) = A * dy_v + mu * lap_w1;
+            double dw[2] = {A * dx_v + mu * lap_w0, A * dy_v + mu * lap_w1};
+            for (int n = 0; n < 2; n++) {
+                if (fused && !in_place) {
+                    w_out(i, j, n) = sa * w_start(i, j, n) + sb * w_view(i, j, n) 
+                                   + sc * dw[n];
+                } else {
+                    dw_out(i, j, n) = dw[n];
+                }
+            }
         });
 
+        if (in_place) {
+            Kokkos::parallel_for( "Interface Vorticity Update",
+                createExecutionPolicy(own_node_space, ExecutionSpace()), 
+                KOKKOS_LAMBDA(int i, int j) {
+                for (int n = 0; n < 2; n++) {
+                    w_out(i, j, n) = sa * w_start(i, j, n) + sb * w_out(i, j, n) 
+                                   + sc * zdot(i, j, n);
+                }
+            });
+        }
+
     }
 
   private:
@@ -424,12 +799,17 @@ class ZModel
     const BRSolver *_br;
     double _dx, _dy;
     double _A, _g, _mu;
+    bool _implicit_viscosity;
     std::shared_ptr<node_array> _V;
     std::shared_ptr<halo_type> _v_halo;
+    std::shared_ptr<node_array> _geometry;
+    ExecutionSpace _geometry_space;
 
-    /* XXX Make this conditional on not being the high-order model */ 
+    /* Only allocated by the models that use the reisz transform, except 
+     * that _reisz and _fft also serve implicit viscosity */
     std::shared_ptr<node_array> _reisz;
-    std::shared_ptr<node_array> _C1, _C2; 
+    std::shared_ptr<node_array> _reisz_multipliers; 
+    std::shared_ptr<node_array> _viscosity_symbol;
     std::shared_ptr<Cabana::Grid::Experimental::HeffteFastFourierTransform<Cabana::Grid::Node, mesh_type, double, memory_space, exec_space, Cabana::Grid::Experimental::Impl::FFTBackendDefault>> _fft;
 }; // class ZModel
 
@@ -0,0 +1,257 @@
+#include "gtest/gtest.h"
+
+#include <Kokkos_Core.hpp>
+
+#include <SolverParams.hpp>
+
+#include <mpi.h>
+
+#include <vector>
+
+#include "tstDriver.hpp"
+#include "tstBRSolver.hpp"
+
+TYPED_TEST_SUITE( BRSolverTest, MeshDeviceTypes );
+
+const std::vector<Beatnik::BoundaryType> testBoundaries = { Beatnik::PERIODIC,
+                                                            Beatnik::FREE };
+
+TYPED_TEST( BRSolverTest, KernelsMatchFlat )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_EXACT;
+
+    /* Every all-pairs kernel sums the same pairs, only in a different
+     * order, so they agree with the flat kernel to roundoff */
+    const std::vector<Beatnik::BRKernel> kernels = { Beatnik::BR_KERNEL_TEAM,
+                                                     Beatnik::BR_KERNEL_TILED,
+                                                     Beatnik::BR_KERNEL_SIMD };
+
+    /* On four processes, 13 nodes gives blocks of 36 to 49 points, smaller
+     * than one tile of points or sources, and 37 nodes gives blocks of 324
+     * to 361, which end in partial tiles of both. 16 nodes gives a 49 point
+     * block on the periodic interface too, so that with either boundary
+     * some block doesn't fill a whole number of SIMD vectors. */
+    const std::vector<int> meshSizes = { 13, 16, 33, 37 };
+    for ( auto boundary : testBoundaries )
+    {
+        for ( int num_nodes : meshSizes )
+        {
+            this->setUpInterface( boundary, num_nodes );
+            for ( auto kernel : kernels )
+            {
+                params.br_kernel = kernel;
+                EXPECT_LT( this->relativeError( params ), 1e-12 )
+                    << "boundary " << boundary << ", " << num_nodes
+                    << " nodes, kernel " << kernel;
+            }
+        }
+    }
+};
+
+TYPED_TEST( BRSolverTest, SymmetricMatchesRingPass )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_EXACT;
+    params.br_symmetric = true;
+
+    /* The symmetric pass only changes which process evaluates each pair,
+     * so it agrees with the full ring pass to roundoff. With an even number
+     * of processes its last step is not reciprocal, which the four process
+     * run covers; the three process run covers an odd ring. */
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+        EXPECT_LT( this->relativeError( params ), 1e-12 ) << "boundary " << boundary;
+    }
+};
+
+TYPED_TEST( BRSolverTest, TreecodeConvergesWithTheta )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_TREECODE;
+    params.br_leaf_size = 8;
+
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+
+        /* Opening fewer cells makes the treecode more accurate */
+        std::vector<double> thetas = { 0.8, 0.4, 0.2 };
+        std::vector<double> errors;
+        for ( double theta : thetas )
+        {
+            params.br_theta = theta;
+            errors.push_back( this->relativeError( params ) );
+        }
+        for ( std::size_t i = 1; i < errors.size(); i++ )
+            EXPECT_LT( errors[i], errors[i - 1] )
+                << "boundary " << boundary << ", theta " << thetas[i];
+        EXPECT_LT( errors.back(), 1e-2 ) << "boundary " << boundary;
+
+        /* With an opening angle this small no expansion is ever used, so
+         * what's left is the exact sum over the exchanged sources and
+         * their periodic images */
+        params.br_theta = 1e-6;
+        EXPECT_LT( this->relativeError( params ), 1e-10 ) << "boundary " << boundary;
+    }
+};
+
+TYPED_TEST( BRSolverTest, TreecodeRefitsLocalTree )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_TREECODE;
+    params.br_leaf_size = 8;
+    params.br_theta = 0.4;
+
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+        typename TestFixture::treecode_type treecode( *this->pm_, this->bc_, this->epsilon_,
+                                                      this->dx_, this->dy_, params );
+        auto built = this->velocity( treecode );
+
+        /* Moving the interface rigidly keeps every bounding sphere the same
+         * size, so the second call refits the local tree rather than
+         * rebuilding it, and has to move its sources and cells along with
+         * the interface to get the same velocity. Moving it by a multiple
+         * of the node spacing shifts every x coordinate exactly, so the
+         * essential tree and every opening decision come out the same. */
+        this->translateInterface( 4 * this->dx_ );
+        auto refit = this->velocity( treecode );
+        EXPECT_LT( this->relativeDifference( refit, built ), 1e-12 ) << "boundary " << boundary;
+    }
+};
+
+TYPED_TEST( BRSolverTest, FMMConvergesWithOrder )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_FMM;
+    params.br_leaf_size = 8;
+    params.br_theta = 0.5;
+
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+
+        /* At a fixed opening angle, every extra order of the expansions
+         * buys accuracy */
+        std::vector<int> orders = { 1, 2, 3, 4 };
+        std::vector<double> errors;
+        for ( int order : orders )
+        {
+            params.br_fmm_order = order;
+            errors.push_back( this->relativeError( params ) );
+        }
+        for ( std::size_t i = 1; i < errors.size(); i++ )
+            EXPECT_LT( errors[i], errors[i - 1] )
+                << "boundary " << boundary << ", order " << orders[i];
+        EXPECT_LT( errors.back(), 0.1 * errors.front() ) << "boundary " << boundary;
+    }
+};
+
+TYPED_TEST( BRSolverTest, CutoffConvergesWithCutoff )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_CUTOFF;
+
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+
+        /* Each larger cutoff leaves out less of the far field */
+        std::vector<double> cutoffs = { 0.25, 0.5, 1.0 };
+        std::vector<double> errors;
+        for ( double cutoff : cutoffs )
+        {
+            params.br_cutoff = cutoff;
+            errors.push_back( this->relativeError( params ) );
+        }
+        for ( std::size_t i = 1; i < errors.size(); i++ )
+            EXPECT_LT( errors[i], errors[i - 1] )
+                << "boundary " << boundary << ", cutoff " << cutoffs[i];
+    }
+};
+
+TYPED_TEST( BRSolverTest, P3MIndependentOfCutoff )
+{
+    /* P3M only supports periodic interfaces */
+    this->setUpInterface( Beatnik::PERIODIC );
+
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_P3M;
+    params.br_mesh_spacing = 0.05;
+
+    /* The Ewald splitting parameter scales with the inverse of the cutoff,
+     * so moving the cutoff only moves work between the direct and mesh
+     * sums and leaves the velocity the same */
+    params.br_cutoff = 0.5;
+    auto reference = this->velocity( params );
+    for ( double cutoff : { 0.75, 1.0 } )
+    {
+        params.br_cutoff = cutoff;
+        EXPECT_LT( this->relativeDifference( this->velocity( params ), reference ), 1e-2 )
+            << "cutoff " << cutoff;
+    }
+
+    /* P3M sums every periodic image rather than the nearest ones, but
+     * those beyond them barely contribute for this mode */
+    EXPECT_LT( this->relativeDifference( reference, this->exact_ ), 5e-2 );
+};
+
+TYPED_TEST( BRSolverTest, P3MIndependentOfPadding )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_P3M;
+    params.br_mesh_spacing = 0.05;
+    params.br_cutoff = 0.5;
+
+    /* A net sheet strength makes the velocity jump across the interface
+     * rather than decay, so on the mesh, which is only periodic in z
+     * because it is padded, the solution depends on the padding unless it
+     * is corrected for. Doubling the height of the bounding box doubles
+     * the padding and keeps the mesh nodes where they were. */
+    this->setUpInterface( Beatnik::PERIODIC, 33, 0.5, 1.0 );
+    auto reference = this->velocity( params );
+    this->setUpInterface( Beatnik::PERIODIC, 33, 0.5, 2.0 );
+    EXPECT_LT( this->relativeDifference( this->velocity( params ), reference ), 1e-4 );
+};
+
+TYPED_TEST( BRSolverTest, VortexInCellConvergesWithSpacing )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_VIC;
+
+    for ( auto boundary : testBoundaries )
+    {
+        this->setUpInterface( boundary );
+
+        /* The mesh spacing is the vortex-in-cell smoothing length, so the
+         * velocity approaches the exact one as it shrinks. The spacings
+         * stay coarser than the interface points so every cell sees some. */
+        std::vector<double> spacings = { 0.4, 0.2, 0.1 };
+        std::vector<double> errors;
+        for ( double spacing : spacings )
+        {
+            params.br_mesh_spacing = spacing;
+            errors.push_back( this->relativeError( params ) );
+        }
+        for ( std::size_t i = 1; i < errors.size(); i++ )
+            EXPECT_LT( errors[i], errors[i - 1] )
+                << "boundary " << boundary << ", spacing " << spacings[i];
+    }
+};
+
+TYPED_TEST( BRSolverTest, VortexInCellIndependentOfPadding )
+{
+    Beatnik::SolverParams params;
+    params.br_solver = Beatnik::BR_SOLVER_VIC;
+    params.br_mesh_spacing = 0.1;
+
+    /* As for P3M, a net sheet strength on the periodic interface must not
+     * make the velocity depend on how far the mesh is padded in z */
+    this->setUpInterface( Beatnik::PERIODIC, 33, 0.5, 1.0 );
+    auto reference = this->velocity( params );
+    this->setUpInterface( Beatnik::PERIODIC, 33, 0.5, 2.0 );
+    EXPECT_LT( this->relativeDifference( this->velocity( params ), reference ), 1e-4 );
+};
@@ -0,0 +1,198 @@
+#ifndef _TSTBRSOLVER_HPP_
+#define _TSTBRSOLVER_HPP_
+
+#include "gtest/gtest.h"
+
+#include <Cabana_Core.hpp>
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <BoundaryCondition.hpp>
+#include <ExactBRSolver.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <Solver.hpp>
+#include <SolverParams.hpp>
+#include <TreecodeBRSolver.hpp>
+
+#include <mpi.h>
+
+#include <cmath>
+#include <memory>
+
+#include "tstDriver.hpp"
+
+/* One cosine mode of interface height carrying a smooth vorticity, so the
+ * BR velocity is smooth and every approximate solver should converge to
+ * the exact one. The mode is periodic on the test bounding box. A nonzero
+ * sheet strength adds a constant to the second vorticity component, giving
+ * the interface a net sheet strength. */
+class BRModeInitFunctor
+{
+  public:
+    BRModeInitFunctor( double dx, double dy, double period, double sheet = 0.0 )
+        : _dx( dx )
+        , _dy( dy )
+        , _k( 2.0 * Kokkos::numbers::pi_v<double> / period )
+        , _sheet( sheet )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Position,
+                     [[maybe_unused]] const int index[2],
+                     const double coord[2],
+                     double& z1, double& z2, double& z3 ) const
+    {
+        z1 = _dx * coord[0];
+        z2 = _dy * coord[1];
+        z3 = 0.1 * cos( _k * z1 ) * cos( _k * z2 );
+        return true;
+    };
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Vorticity,
+                     [[maybe_unused]] const int index[2],
+                     const double coord[2],
+                     double& w1, double& w2 ) const
+    {
+        double x = _dx * coord[0], y = _dy * coord[1];
+        w1 = sin( _k * x ) * cos( _k * y );
+        w2 = 0.5 * cos( _k * x ) * sin( _k * y ) + _sheet;
+        return true;
+    };
+
+  private:
+    double _dx, _dy, _k, _sheet;
+};
+
+/* Compares the far-field BR solvers against the exact solver on a small
+ * interface, either periodic or with free boundaries */
+template <class T>
+class BRSolverTest : public ::testing::Test
+{
+  public:
+    using ExecutionSpace = typename T::ExecutionSpace;
+    using MemorySpace = typename T::MemorySpace;
+    using device_type = Kokkos::Device<ExecutionSpace, MemorySpace>;
+    using node_view = Kokkos::View<double***, device_type>;
+
+    using mesh_type = Beatnik::Mesh<ExecutionSpace, MemorySpace>;
+    using pm_type = Beatnik::ProblemManager<ExecutionSpace, MemorySpace>;
+    using exact_type = Beatnik::ExactBRSolver<ExecutionSpace, MemorySpace>;
+    using treecode_type = Beatnik::TreecodeBRSolver<ExecutionSpace, MemorySpace>;
+
+    /* Build the interface with the given boundary type, number of nodes in
+     * each direction and sheet strength, in a bounding box of the given
+     * half height in z, and compute its exact BR velocity */
+    void setUpInterface( Beatnik::BoundaryType boundary, int num_nodes = 33,
+                         double sheet = 0.0, double height = 1.0 )
+    {
+        /* The problem manager refers to the mesh, so release it first */
+        pm_ = nullptr;
+
+        globalNumNodes_ = { num_nodes, num_nodes };
+        globalBoundingBox_[2] = -height;
+        globalBoundingBox_[5] = height;
+
+        std::array<bool, 2> periodic = { boundary == Beatnik::PERIODIC,
+                                         boundary == Beatnik::PERIODIC };
+        mesh_ = std::make_unique<mesh_type>( globalBoundingBox_, globalNumNodes_,
+                                             periodic, partitioner_, haloWidth_,
+                                             MPI_COMM_WORLD );
+
+        for ( int i = 0; i < 6; i++ )
+            bc_.bounding_box[i] = globalBoundingBox_[i];
+        bc_.boundary_type = { boundary, boundary, boundary, boundary };
+
+        /* Nodes are one spacing apart, so the periodic interface tiles the
+         * bounding box exactly and the free one spans it */
+        dx_ = ( globalBoundingBox_[3] - globalBoundingBox_[0] ) / ( globalNumNodes_[0] - 1 );
+        dy_ = ( globalBoundingBox_[4] - globalBoundingBox_[1] ) / ( globalNumNodes_[1] - 1 );
+        epsilon_ = 0.25 * sqrt( dx_ * dy_ );
+
+        pm_ = std::make_unique<pm_type>( *mesh_, bc_, BRModeInitFunctor( dx_, dy_, 1.0, sheet ) );
+
+        exact_type exact( *pm_, bc_, epsilon_, dx_, dy_ );
+        exact_ = velocity( exact );
+    }
+
+    /* Move the whole interface by dx in x, which leaves its velocity
+     * unchanged */
+    void translateInterface( double dx )
+    {
+        auto z = pm_->get( Cabana::Grid::Node(), Beatnik::Field::Position() );
+        auto all = mesh_->localGrid()->indexSpace( Cabana::Grid::Ghost(), Cabana::Grid::Node(),
+                                                   Cabana::Grid::Local() );
+        Kokkos::parallel_for( "BR Test Translate",
+            Cabana::Grid::createExecutionPolicy( all, ExecutionSpace() ),
+            KOKKOS_LAMBDA( const int i, const int j ) { z( i, j, 0 ) += dx; } );
+        Kokkos::fence();
+    }
+
+    /* Velocity of the interface computed by a BR solver */
+    node_view velocity( const Beatnik::BRSolverBase<ExecutionSpace, MemorySpace> & br ) const
+    {
+        auto z = pm_->get( Cabana::Grid::Node(), Beatnik::Field::Position() );
+        auto w = pm_->get( Cabana::Grid::Node(), Beatnik::Field::Vorticity() );
+        node_view zdot( "BR test zdot", z.extent( 0 ), z.extent( 1 ), 3 );
+        br.computeInterfaceVelocity( zdot, z, w );
+        return zdot;
+    }
+
+    /* Velocity of the interface computed by the configured BR solver */
+    node_view velocity( const Beatnik::SolverParams & params ) const
+    {
+        auto br = Beatnik::createBRSolver<ExecutionSpace, MemorySpace>(
+            *pm_, bc_, epsilon_, dx_, dy_, params );
+        return velocity( *br );
+    }
+
+    /* Largest difference between two velocities of the owned points,
+     * relative to the largest reference velocity */
+    double relativeDifference( node_view zdot, node_view reference ) const
+    {
+        auto own = mesh_->localGrid()->indexSpace( Cabana::Grid::Own(), Cabana::Grid::Node(),
+                                                   Cabana::Grid::Local() );
+        double errors[2] = { 0.0, 0.0 };
+        Kokkos::parallel_reduce( "BR Test Error",
+            Cabana::Grid::createExecutionPolicy( own, ExecutionSpace() ),
+            KOKKOS_LAMBDA( const int i, const int j, double& max_error ) {
+                for ( int d = 0; d < 3; d++ )
+                    max_error = Kokkos::max( max_error, Kokkos::fabs( zdot( i, j, d ) - reference( i, j, d ) ) );
+            }, Kokkos::Max<double>( errors[0] ) );
+        Kokkos::parallel_reduce( "BR Test Magnitude",
+            Cabana::Grid::createExecutionPolicy( own, ExecutionSpace() ),
+            KOKKOS_LAMBDA( const int i, const int j, double& max_value ) {
+                for ( int d = 0; d < 3; d++ )
+                    max_value = Kokkos::max( max_value, Kokkos::fabs( reference( i, j, d ) ) );
+            }, Kokkos::Max<double>( errors[1] ) );
+        MPI_Allreduce( MPI_IN_PLACE, errors, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+        return errors[0] / errors[1];
+    }
+
+    /* Error of the configured BR solver relative to the exact solver */
+    double relativeError( const Beatnik::SolverParams & params ) const
+    {
+        return relativeDifference( velocity( params ), exact_ );
+    }
+
+    virtual void TearDown() override
+    {
+        pm_ = nullptr;
+        mesh_ = nullptr;
+    }
+
+    std::array<double, 6> globalBoundingBox_ = { -1, -1, -1, 1, 1, 1 };
+    std::array<int, 2> globalNumNodes_;
+    const int haloWidth_ = 2;
+    Cabana::Grid::DimBlockPartitioner<2> partitioner_;
+
+    Beatnik::BoundaryCondition bc_;
+    double dx_, dy_, epsilon_;
+    std::unique_ptr<mesh_type> mesh_;
+    std::unique_ptr<pm_type> pm_;
+    node_view exact_;
+};
+
+#endif // _TSTBRSOLVER_HPP_
@@ -14,7 +14,7 @@ struct DeviceType
 
 using MeshDeviceTypes = ::testing::Types<
 #ifdef KOKKOS_ENABLE_OPENMP
-/   DeviceType<Kokkos::OpenMP, Kokkos::HostSpace>,
+    DeviceType<Kokkos::OpenMP, Kokkos::HostSpace>,
 #endif
 #ifdef KOKKOS_ENABLE_CUDA
     DeviceType<Kokkos::Cuda, Kokkos::CudaSpace>,
@@ -1,7 +1,7 @@
 #include "gtest/gtest.h"
 
 #include <Cabana_Core.hpp>
-#include <Cajita.hpp>
+#include <Cabana_Grid.hpp>
 #include <Kokkos_Core.hpp>
 
 #include <Mesh.hpp>
@@ -35,7 +35,7 @@ TYPED_TEST( MeshTest, PeriodicGridSetup )
     for ( int i = 0; i < 2; i++ )
     {
         EXPECT_EQ( cabana_nodes,
-                   global_grid.globalNumEntity( Cajita::Node(), i ) );
+                   global_grid.globalNumEntity( Cabana::Grid::Node(), i ) );
     }
 };
 TYPED_TEST( MeshTest, NonperiodicGridSetup )
@@ -50,12 +50,12 @@ TYPED_TEST( MeshTest, NonperiodicGridSetup )
     for ( int i = 0; i < 2; i++ )
     {
         EXPECT_EQ( this->boxNodes_,
-                   global_grid.globalNumEntity( Cajita::Node(), i ) );
+                   global_grid.globalNumEntity( Cabana::Grid::Node(), i ) );
     }
 
     /* Make sure the number of owned nodes is our share of what was requested */
     auto own_local_node_space = local_grid->indexSpace(
-        Cajita::Own(), Cajita::Node(), Cajita::Local() );
+        Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local() );
     for ( int i = 0; i < 2; i++ )
     {
         EXPECT_EQ( own_local_node_space.extent( i ),
@@ -67,7 +67,7 @@ TYPED_TEST( MeshTest, NonperiodicGridSetup )
      * the ghosts in each dimension. 
      */
     auto ghost_local_node_space = local_grid->indexSpace(
-        Cajita::Ghost(), Cajita::Node(), Cajita::Local() );
+        Cabana::Grid::Ghost(), Cabana::Grid::Node(), Cabana::Grid::Local() );
     for ( int i = 0; i < 2; i++ ) {
         EXPECT_EQ( ghost_local_node_space.extent( i ),
                    this->boxNodes_ / global_grid.dimNumBlock( i ) +
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <Kokkos_Core.hpp>
+
+#include <Operators.hpp>
+
+#include <mpi.h>
+
+#include "tstDriver.hpp"
+
+template <class T>
+class OperatorsTest : public ::testing::Test
+{
+  public:
+    using ExecutionSpace = typename T::ExecutionSpace;
+    using MemorySpace = typename T::MemorySpace;
+    using view_type = Kokkos::View<double***, Kokkos::LayoutRight, MemorySpace>;
+
+    /* Apply the 9-point laplace stencil to the real part of the mode with
+     * global index (g1, g2) on an n1 x n2 periodic mesh and return the
+     * largest difference from the mode scaled by its Fourier symbol */
+    double laplaceSymbolError( int n1, int n2, int g1, int g2 )
+    {
+        /* One layer of periodic ghosts around the mesh */
+        view_type f( "mode", n1 + 2, n2 + 2, 1 );
+        double dx = dx_, dy = dy_;
+        double t1 = 2.0 * Kokkos::numbers::pi_v<double> * g1 / n1;
+        double t2 = 2.0 * Kokkos::numbers::pi_v<double> * g2 / n2;
+
+        Kokkos::parallel_for( "Fill Mode",
+            Kokkos::MDRangePolicy<ExecutionSpace, Kokkos::Rank<2>>( {0, 0}, {n1 + 2, n2 + 2} ),
+            KOKKOS_LAMBDA( const int i, const int j ) {
+            f( i, j, 0 ) = cos( t1 * ( i - 1 ) + t2 * ( j - 1 ) );
+        } );
+
+        double error = 0.0;
+        Kokkos::parallel_reduce( "Laplace Symbol Error",
+            Kokkos::MDRangePolicy<ExecutionSpace, Kokkos::Rank<2>>( {1, 1}, {n1 + 1, n2 + 1} ),
+            KOKKOS_LAMBDA( const int i, const int j, double & max_error ) {
+            double lap = Beatnik::Operators::laplace( f, i, j, 0, dx, dy );
+            double symbol = Beatnik::Operators::laplaceSymbol( g1, n1, g2, n2, dx, dy );
+            double diff = Kokkos::fabs( lap - symbol * f( i, j, 0 ) );
+            if ( diff > max_error ) max_error = diff;
+        }, Kokkos::Max<double>( error ) );
+        return error;
+    }
+
+    const double dx_ = 0.25;
+    const double dy_ = 0.125;
+};
+
+TYPED_TEST_SUITE( OperatorsTest, MeshDeviceTypes );
+
+TYPED_TEST( OperatorsTest, LaplaceSymbolEvenNodes )
+{
+    /* Every mode of an even mesh, including the Nyquist modes */
+    int n = 8;
+    for ( int g1 = 0; g1 < n; g1++ )
+    {
+        for ( int g2 = 0; g2 < n; g2++ )
+        {
+            EXPECT_LT( this->laplaceSymbolError( n, n, g1, g2 ), 1e-10 )
+                << "mode (" << g1 << ", " << g2 << ")";
+        }
+    }
+};
+
+TYPED_TEST( OperatorsTest, LaplaceSymbolOddNodes )
+{
+    int n = 9;
+    for ( int g1 = 0; g1 < n; g1++ )
+    {
+        for ( int g2 = 0; g2 < n; g2++ )
+        {
+            EXPECT_LT( this->laplaceSymbolError( n, n, g1, g2 ), 1e-10 )
+                << "mode (" << g1 << ", " << g2 << ")";
+        }
+    }
+};
+
+TYPED_TEST( OperatorsTest, LaplaceSymbolMixedNodes )
+{
+    /* An even and an odd dimension, checking the Nyquist mode of the even
+     * one against every mode of the odd one */
+    int n1 = 10, n2 = 7;
+    for ( int g2 = 0; g2 < n2; g2++ )
+    {
+        EXPECT_LT( this->laplaceSymbolError( n1, n2, n1 / 2, g2 ), 1e-10 )
+            << "mode (" << n1 / 2 << ", " << g2 << ")";
+    }
+};
+
+TYPED_TEST( OperatorsTest, LaplaceSymbolNonPositive )
+{
+    int n = 8;
+    for ( int g1 = 0; g1 < n; g1++ )
+    {
+        for ( int g2 = 0; g2 < n; g2++ )
+        {
+            EXPECT_LE( Beatnik::Operators::laplaceSymbol( g1, n, g2, n, this->dx_, this->dy_ ), 0.0 );
+        }
+    }
+    EXPECT_EQ( Beatnik::Operators::laplaceSymbol( 0, n, 0, n, this->dx_, this->dy_ ), 0.0 );
+};
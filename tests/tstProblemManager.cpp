@@ -1,5 +1,5 @@
 #include <Cabana_Core.hpp>
-#include <Cajita.hpp>
+#include <Cabana_Grid.hpp>
 #include <Kokkos_Core.hpp>
 #include <ProblemManager.hpp>
 
@@ -11,7 +11,7 @@
 
 TYPED_TEST_SUITE( ProblemManagerTest, MeshDeviceTypes );
 
-using Node = Cajita::Cell;
+using Node = Cabana::Grid::Node;
 using Position = Beatnik::Field::Position;
 using Vorticity = Beatnik::Field::Vorticity;
 
@@ -21,19 +21,19 @@ TYPED_TEST( ProblemManagerTest, StateArrayTest )
 
     // Get basic mesh state
     auto pm = this->testPM_;
-    auto mesh = pm->mesh();
+    auto & mesh = pm->mesh();
     auto z = pm->get( Node(), Position() );
     auto w = pm->get( Node(), Vorticity() );
-    auto rank = mesh->rank();
+    auto rank = mesh.rank();
 
     /* Set values in the array based on our rank. Each cell gets a value of
      * rank*1000 + i * 100 + j * 10 + dim
      */
-    auto zspace = mesh->localGrid()->indexSpace( Cajita::Own(), Node(),
-                                                 Cajita::Local() );
+    auto zspace = mesh.localGrid()->indexSpace( Cabana::Grid::Own(), Node(),
+                                                Cabana::Grid::Local() );
     Kokkos::parallel_for(
         "InitializeCellFields",
-        createExecutionPolicy( zspace, ExecutionSpace() ),
+        Cabana::Grid::createExecutionPolicy( zspace, ExecutionSpace() ),
         KOKKOS_LAMBDA( const int i, const int j ) {
 	    for (int d = 0; d < 3; d++)
                 z( i, j, d ) = rank * 1000 + i * 100 + j * 10 + d;
@@ -60,36 +60,49 @@ TYPED_TEST( ProblemManagerTest, HaloTest )
     using ExecutionSpace = typename TestFixture::ExecutionSpace;
 
     auto pm = this->testPM_;
-    auto mesh = pm->mesh();
-    auto rank = mesh->rank();
+    auto & mesh = pm->mesh();
+    auto local_grid = mesh.localGrid();
     auto z = pm->get( Node(), Position() );
-    auto zspace = mesh->localGrid()->indexSpace( Cajita::Own(), Node(),
-                                                 Cajita::Local() );
+    auto w = pm->get( Node(), Vorticity() );
+
+    /* Set values in the arrays based on the global index of each node, 
+     * gi * 10000 + gj * 10 + dim, so that after the gather every ghost
+     * holds the value of the node it is a copy of, which the periodic 
+     * local to global conversion gives us. */
+    auto L2G = Cabana::Grid::IndexConversion::L2G<Cabana::Grid::UniformMesh<double, 2>,
+                                                  Node>( *local_grid );
+    auto zspace = local_grid->indexSpace( Cabana::Grid::Own(), Node(),
+                                          Cabana::Grid::Local() );
     Kokkos::parallel_for(
         "InitializePositions",
-        createExecutionPolicy( uspace, ExecutionSpace() ),
+        Cabana::Grid::createExecutionPolicy( zspace, ExecutionSpace() ),
         KOKKOS_LAMBDA( const int i, const int j ) {
+            int li[2] = { i, j }, gi[2];
+            L2G( li, gi );
             for (int d = 0; d < 3; d++)
-                z( i, j, d ) = rank * 1000 + i * 100 + j * 10 + d;
+                z( i, j, d ) = gi[0] * 10000 + gi[1] * 10 + d;
+            for (int d = 0; d < 2; d++)
+                w( i, j, d ) = gi[0] * 10000 + gi[1] * 10 + d;
         } );
 
-    // Check that we can halo the views appropriately, using the FaceI direction
-    // as the check
     pm->gather( );
-    std::array<int, 2> directions[4] = {
-        { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+    /* The periodic boundary condition shifts the x and y positions of the
+     * ghosts across the boundary by the width of the domain, so only the 
+     * height is compared there */
     auto zcopy =
         Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), z );
-    for ( int i = 0; i < 4; i++ )
-    {
-        auto dir = directions[i];
-        int neighbor_rank = mesh->localGrid()->neighborRank( dir );
-        auto z_shared_space = mesh->localGrid()->sharedIndexSpace(
-            Cajita::Ghost(), Node(), dir );
-        for ( int i = z_shared_space.min( 0 ); i < z_shared_space.max( 0 ); i++ )
-            for ( int j = z_shared_space.min( 1 ); j < z_shared_space.max( 1 ); j++ )
-                for (int d = 0; d < 3; d++)
-                    ASSERT_EQ( zcopy( i, j, 0 ),
-                               neighbor_rank * 1000 + i * 100 + j * 10 + d );
-    }
+    auto wcopy =
+        Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), w );
+    auto ghost_space = local_grid->indexSpace( Cabana::Grid::Ghost(), Node(),
+                                               Cabana::Grid::Local() );
+    for ( int i = ghost_space.min( 0 ); i < ghost_space.max( 0 ); i++ )
+        for ( int j = ghost_space.min( 1 ); j < ghost_space.max( 1 ); j++ )
+        {
+            int li[2] = { i, j }, gi[2];
+            L2G( li, gi );
+            ASSERT_EQ( zcopy( i, j, 2 ), gi[0] * 10000 + gi[1] * 10 + 2 );
+            for (int d = 0; d < 2; d++)
+                ASSERT_EQ( wcopy( i, j, d ), gi[0] * 10000 + gi[1] * 10 + d );
+        }
 }
@@ -2,8 +2,10 @@
 #define _TSTPROBLEMMANGER_HPP_
 
 #include <Cabana_Core.hpp>
-#include <Cajita.hpp>
+#include <Cabana_Grid.hpp>
 #include <Kokkos_Core.hpp>
+
+#include <BoundaryCondition.hpp>
 #include <ProblemManager.hpp>
 
 #include <mpi.h>
@@ -15,7 +17,7 @@ class NullInitFunctor
 {
   public:
     KOKKOS_INLINE_FUNCTION
-    bool operator()( Cajita::Node, Beatnik::Field::Position,
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Position,
                      [[maybe_unused]] const int index[Dim],
                      [[maybe_unused]] const double x[Dim],
                      [[maybe_unused]] double& z1, 
@@ -26,7 +28,7 @@ class NullInitFunctor
     };
 
     KOKKOS_INLINE_FUNCTION
-    bool operator()( Cajita::Node, Beatnik::Field::Vorticity,
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Vorticity,
                      [[maybe_unused]] const int index[Dim],
                      [[maybe_unused]] const double x[Dim],
                      [[maybe_unused]] double& w1,
@@ -39,22 +41,29 @@ class NullInitFunctor
 template <class T>
 class ProblemManagerTest : public MeshTest<T>
 {
-
     using pm_type = Beatnik::ProblemManager<typename T::ExecutionSpace,
                                             typename T::MemorySpace>;
 
+  public:
     using ExecutionSpace = typename T::ExecutionSpace;
     using MemorySpace = typename T::MemorySpace;
 
-  public:
     NullInitFunctor<2> createFunctor_;
+    Beatnik::BoundaryCondition bc_;
     std::shared_ptr<pm_type> testPM_;
 
     virtual void SetUp() override
     {
         MeshTest<T>::SetUp();
+
+        /* The problem is set up on the periodic mesh, so its boundaries
+         * are periodic too */
+        for ( int i = 0; i < 6; i++ )
+            bc_.bounding_box[i] = this->globalBoundingBox_[i];
+        bc_.boundary_type = { Beatnik::PERIODIC, Beatnik::PERIODIC,
+                              Beatnik::PERIODIC, Beatnik::PERIODIC };
         this->testPM_ =
-            std::make_shared<pm_type>( *this->testMesh_, createFunctor_ );
+            std::make_shared<pm_type>( *this->testMeshPeriodic_, bc_, createFunctor_ );
     }
 
     virtual void TearDown() override
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include <Kokkos_Core.hpp>
+
+#include <SolverParams.hpp>
+#include <TimeIntegrator.hpp>
+
+#include <mpi.h>
+
+#include <vector>
+
+#include "tstDriver.hpp"
+#include "tstTimeIntegrator.hpp"
+
+struct SchemeOrder
+{
+    Beatnik::TimeScheme scheme;
+    double order;
+    int stages;
+};
+
+const std::vector<SchemeOrder> tableSchemes = {
+    { Beatnik::TIME_TVD_RK3, 3.0, 3 },
+    { Beatnik::TIME_SSP_RK43, 3.0, 4 },
+    { Beatnik::TIME_RK4, 4.0, 4 },
+};
+
+TEST( RKStageTables, LowStorageHasNoTable )
+{
+    /* The low-storage SSPRK(10,4) is applied in place rather than from a
+     * table, so it must not also be available as one */
+    EXPECT_TRUE( Beatnik::rkStages( Beatnik::TIME_LS_SSP_RK104 ).empty() );
+};
+
+TYPED_TEST_SUITE( TimeIntegratorTest, MeshDeviceTypes );
+
+TYPED_TEST( TimeIntegratorTest, TableConsistency )
+{
+    /* One derivative evaluation per stage, and a state that doesn't change
+     * stays where it is */
+    Beatnik::SolverParams params;
+    for ( auto & s : tableSchemes )
+    {
+        params.time_scheme = s.scheme;
+        int evaluations = 0;
+        EXPECT_LT( this->error( params, 0.0, 0.0, 1.0, 3, &evaluations ), 1e-14 )
+            << "scheme " << s.scheme;
+        EXPECT_EQ( evaluations, 3 * s.stages ) << "scheme " << s.scheme;
+    }
+};
+
+TYPED_TEST( TimeIntegratorTest, TableConvergence )
+{
+    /* du/dt = lambda u, and then du/dt = lambda u + mu u^2, which also
+     * exercises the nonlinear order conditions */
+    Beatnik::SolverParams params;
+    for ( auto & s : tableSchemes )
+    {
+        params.time_scheme = s.scheme;
+        EXPECT_NEAR( this->order( params, -1.3, 0.0 ), s.order, 0.2 )
+            << "scheme " << s.scheme;
+        EXPECT_NEAR( this->order( params, -0.5, 0.8 ), s.order, 0.25 )
+            << "scheme " << s.scheme;
+    }
+};
+
+TYPED_TEST( TimeIntegratorTest, FusedMatchesUnfused )
+{
+    /* Fusing the TVD RK3 stage updates into the ZModel's kernels applies
+     * the same updates, so only roundoff separates the two */
+    Beatnik::SolverParams params;
+    params.time_scheme = Beatnik::TIME_TVD_RK3;
+    double unfused = this->error( params, -0.5, 0.8, 1.0, 10 );
+
+    params.fuse_stages = true;
+    int evaluations = 0;
+    double fused = this->error( params, -0.5, 0.8, 1.0, 10, &evaluations );
+    EXPECT_NEAR( fused, unfused, 1e-12 );
+    EXPECT_EQ( evaluations, 30 );
+};
+
+TYPED_TEST( TimeIntegratorTest, LowStorageConsistency )
+{
+    /* Ten derivative evaluations a step, with every stage updating the
+     * state in place, and a state that doesn't change stays where it is */
+    Beatnik::SolverParams params;
+    params.time_scheme = Beatnik::TIME_LS_SSP_RK104;
+    int evaluations = 0;
+    EXPECT_LT( this->error( params, 0.0, 0.0, 1.0, 3, &evaluations ), 1e-14 );
+    EXPECT_EQ( evaluations, 30 );
+};
+
+TYPED_TEST( TimeIntegratorTest, LowStorageConvergence )
+{
+    Beatnik::SolverParams params;
+    params.time_scheme = Beatnik::TIME_LS_SSP_RK104;
+    EXPECT_NEAR( this->order( params, -1.3, 0.0 ), 4.0, 0.2 );
+    EXPECT_NEAR( this->order( params, -0.5, 0.8 ), 4.0, 0.25 );
+};
@@ -0,0 +1,261 @@
+#ifndef _TSTTIMEINTEGRATOR_HPP_
+#define _TSTTIMEINTEGRATOR_HPP_
+
+#include "gtest/gtest.h"
+
+#include <Cabana_Grid.hpp>
+#include <Kokkos_Core.hpp>
+
+#include <BoundaryCondition.hpp>
+#include <Mesh.hpp>
+#include <ProblemManager.hpp>
+#include <SolverParams.hpp>
+#include <TimeIntegrator.hpp>
+
+#include <mpi.h>
+
+#include <cmath>
+#include <memory>
+
+#include "tstDriver.hpp"
+
+/* Initial state that differs from node to node and from component to
+ * component, so a stage applied to the wrong point or component shows up */
+class ODEInitFunctor
+{
+  public:
+    /* Component c of the state, position then vorticity, at a node */
+    static KOKKOS_INLINE_FUNCTION double initial( const int i, const int j, const int c )
+    {
+        return 0.5 + 0.1 * c + 0.01 * ( ( i + 2 * j ) % 7 );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Position,
+                     const int index[2], [[maybe_unused]] const double coord[2],
+                     double& z1, double& z2, double& z3 ) const
+    {
+        z1 = initial( index[0], index[1], 0 );
+        z2 = initial( index[0], index[1], 1 );
+        z3 = initial( index[0], index[1], 2 );
+        return true;
+    };
+
+    KOKKOS_INLINE_FUNCTION
+    bool operator()( Cabana::Grid::Node, Beatnik::Field::Vorticity,
+                     const int index[2], [[maybe_unused]] const double coord[2],
+                     double& w1, double& w2 ) const
+    {
+        w1 = initial( index[0], index[1], 3 );
+        w2 = initial( index[0], index[1], 4 );
+        return true;
+    };
+};
+
+/* Stands in for the ZModel in the time integrator, with every position and
+ * vorticity component of every node following du/dt = lambda u + mu u^2 on
+ * its own. Stage updates are applied the way the ZModel applies them, in
+ * place when asked to, and derivative evaluations are counted. */
+template <class ExecutionSpace, class MemorySpace>
+class StubZModel
+{
+  public:
+    using pm_type = Beatnik::ProblemManager<ExecutionSpace, MemorySpace>;
+    using node_array =
+        Cabana::Grid::Array<double, Cabana::Grid::Node, Cabana::Grid::UniformMesh<double, 2>,
+                            MemorySpace>;
+    using node_view = typename node_array::view_type;
+
+    struct StageUpdate
+    {
+        double a, b, c;
+        node_view z_start, w_start;
+        node_view z_out, w_out;
+    };
+
+    StubZModel( const pm_type& pm, const double lambda, const double mu )
+        : _pm( pm )
+        , _lambda( lambda )
+        , _mu( mu )
+    {
+    }
+
+    static KOKKOS_INLINE_FUNCTION double rate( double u, double lambda, double mu )
+    {
+        return lambda * u + mu * u * u;
+    }
+
+    /* Solution at time t from u0 at time zero */
+    static KOKKOS_INLINE_FUNCTION double exact( double u0, double lambda, double mu, double t )
+    {
+        if ( lambda == 0.0 ) return u0 / ( 1.0 - mu * u0 * t );
+        double e = Kokkos::exp( lambda * t );
+        return lambda * u0 * e / ( lambda + mu * u0 * ( 1.0 - e ) );
+    }
+
+    void computeDerivatives( node_view zdot, node_view wdot ) const
+    {
+        apply( _pm.get( Cabana::Grid::Node(), Beatnik::Field::Position() ),
+               _pm.get( Cabana::Grid::Node(), Beatnik::Field::Vorticity() ),
+               zdot, wdot, nullptr );
+    }
+
+    void computeDerivatives( node_array& z, node_array& w, node_view zdot,
+                             node_view wdot ) const
+    {
+        apply( z.view(), w.view(), zdot, wdot, nullptr );
+    }
+
+    void computeStage( const StageUpdate& stage, node_view zdot ) const
+    {
+        apply( _pm.get( Cabana::Grid::Node(), Beatnik::Field::Position() ),
+               _pm.get( Cabana::Grid::Node(), Beatnik::Field::Vorticity() ),
+               zdot, node_view(), &stage );
+    }
+
+    void computeStage( node_array& z, node_array& w, const StageUpdate& stage,
+                       node_view zdot ) const
+    {
+        apply( z.view(), w.view(), zdot, node_view(), &stage );
+    }
+
+    bool implicitViscosity() const { return false; }
+    void applyImplicitViscosity( [[maybe_unused]] const double delta_t ) const {}
+
+    int evaluations() const { return _evaluations; }
+
+  private:
+    void apply( node_view z, node_view w, node_view zdot, node_view wdot,
+                const StageUpdate* stage ) const
+    {
+        _evaluations++;
+
+        bool fused = ( stage != nullptr );
+        double sa = 0.0, sb = 0.0, sc = 0.0;
+        node_view z_start, w_start, z_out, w_out;
+        if ( fused )
+        {
+            sa = stage->a; sb = stage->b; sc = stage->c;
+            z_start = stage->z_start; w_start = stage->w_start;
+            z_out = stage->z_out; w_out = stage->w_out;
+        }
+
+        double lambda = _lambda, mu = _mu;
+        auto own = _pm.mesh().localGrid()->indexSpace(
+            Cabana::Grid::Own(), Cabana::Grid::Node(), Cabana::Grid::Local() );
+        Kokkos::parallel_for( "Stub ZModel",
+            Cabana::Grid::createExecutionPolicy( own, ExecutionSpace() ),
+            KOKKOS_LAMBDA( const int i, const int j ) {
+                for ( int d = 0; d < 3; d++ )
+                {
+                    double f = rate( z( i, j, d ), lambda, mu );
+                    if ( fused )
+                        z_out( i, j, d ) = sa * z_start( i, j, d ) + sb * z( i, j, d ) + sc * f;
+                    else
+                        zdot( i, j, d ) = f;
+                }
+                for ( int d = 0; d < 2; d++ )
+                {
+                    double f = rate( w( i, j, d ), lambda, mu );
+                    if ( fused )
+                        w_out( i, j, d ) = sa * w_start( i, j, d ) + sb * w( i, j, d ) + sc * f;
+                    else
+                        wdot( i, j, d ) = f;
+                }
+            } );
+    }
+
+    const pm_type& _pm;
+    double _lambda, _mu;
+    mutable int _evaluations = 0;
+};
+
+/* Drives the time integrator with the stub model on a small periodic
+ * surface and compares the state it reaches with the exact solution */
+template <class T>
+class TimeIntegratorTest : public ::testing::Test
+{
+  public:
+    using ExecutionSpace = typename T::ExecutionSpace;
+    using MemorySpace = typename T::MemorySpace;
+
+    using mesh_type = Beatnik::Mesh<ExecutionSpace, MemorySpace>;
+    using pm_type = Beatnik::ProblemManager<ExecutionSpace, MemorySpace>;
+    using model_type = StubZModel<ExecutionSpace, MemorySpace>;
+    using integrator_type = Beatnik::TimeIntegrator<ExecutionSpace, MemorySpace, model_type>;
+
+    virtual void SetUp() override
+    {
+        std::array<bool, 2> periodic = { true, true };
+        mesh_ = std::make_unique<mesh_type>( globalBoundingBox_, globalNumNodes_,
+                                             periodic, partitioner_, haloWidth_,
+                                             MPI_COMM_WORLD );
+        for ( int i = 0; i < 6; i++ )
+            bc_.bounding_box[i] = globalBoundingBox_[i];
+        bc_.boundary_type = { Beatnik::PERIODIC, Beatnik::PERIODIC,
+                              Beatnik::PERIODIC, Beatnik::PERIODIC };
+    }
+
+    /* Integrate du/dt = lambda u + mu u^2 to t_final in num_steps steps of
+     * the configured scheme and return the largest error of any component on
+     * any process. The number of derivative evaluations it took is stored in
+     * evaluations if given. */
+    double error( const Beatnik::SolverParams& params, double lambda, double mu,
+                  double t_final, int num_steps, int* evaluations = nullptr )
+    {
+        pm_ = nullptr;
+        pm_ = std::make_unique<pm_type>( *mesh_, bc_, ODEInitFunctor() );
+
+        model_type model( *pm_, lambda, mu );
+        integrator_type ti( *pm_, bc_, model, params );
+        double delta_t = t_final / num_steps;
+        for ( int n = 0; n < num_steps; n++ )
+            ti.step( delta_t );
+        if ( evaluations ) *evaluations = model.evaluations();
+
+        auto z = pm_->get( Cabana::Grid::Node(), Beatnik::Field::Position() );
+        auto w = pm_->get( Cabana::Grid::Node(), Beatnik::Field::Vorticity() );
+        auto own = mesh_->localGrid()->indexSpace( Cabana::Grid::Own(), Cabana::Grid::Node(),
+                                                   Cabana::Grid::Local() );
+        double max_error = 0.0;
+        Kokkos::parallel_reduce( "Time Integrator Test Error",
+            Cabana::Grid::createExecutionPolicy( own, ExecutionSpace() ),
+            KOKKOS_LAMBDA( const int i, const int j, double& e ) {
+                for ( int c = 0; c < 5; c++ )
+                {
+                    double u = ( c < 3 ) ? z( i, j, c ) : w( i, j, c - 3 );
+                    double u0 = ODEInitFunctor::initial( i, j, c );
+                    double exact = model_type::exact( u0, lambda, mu, t_final );
+                    e = Kokkos::max( e, Kokkos::fabs( u - exact ) );
+                }
+            }, Kokkos::Max<double>( max_error ) );
+        MPI_Allreduce( MPI_IN_PLACE, &max_error, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+        return max_error;
+    }
+
+    /* Observed order of convergence of the configured scheme when the
+     * timestep is halved, integrating to t = 1 */
+    double order( const Beatnik::SolverParams& params, double lambda, double mu )
+    {
+        double e1 = error( params, lambda, mu, 1.0, 10 );
+        double e2 = error( params, lambda, mu, 1.0, 20 );
+        return std::log2( e1 / e2 );
+    }
+
+    virtual void TearDown() override
+    {
+        pm_ = nullptr;
+        mesh_ = nullptr;
+    }
+
+    const std::array<double, 6> globalBoundingBox_ = { -1, -1, -1, 1, 1, 1 };
+    const std::array<int, 2> globalNumNodes_ = { 16, 16 };
+    const int haloWidth_ = 2;
+    Cabana::Grid::DimBlockPartitioner<2> partitioner_;
+
+    Beatnik::BoundaryCondition bc_;
+    std::unique_ptr<mesh_type> mesh_;
+    std::unique_ptr<pm_type> pm_;
+};
+
+#endif // _TSTTIMEINTEGRATOR_HPP_